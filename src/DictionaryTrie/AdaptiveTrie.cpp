@@ -0,0 +1,432 @@
+/**
+ * This File shows the implementation details of
+ * AdaptiveTrie class methods, which are declared
+ * in "AdaptiveTrie.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "AdaptiveTrie.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* It is the constructor of Node48, with no child */
+AdaptiveTrie::Node48::Node48() { memset(index, 0, sizeof(index)); }
+
+/* It is the constructor of Node256, with no child */
+AdaptiveTrie::Node256::Node256() { memset(children, 0, sizeof(children)); }
+
+/* It is the constructor */
+AdaptiveTrie::AdaptiveTrie() { root = 0; }
+
+/* Insert a word with its frequency into the trie.
+    arguments: the word, its frequency
+    return: true if the word was inserted, false if it is empty or already
+    in the trie
+ */
+bool AdaptiveTrie::insert(string_view word, unsigned int freq) {
+    if (word.length() == 0) {
+        return false;
+    }
+    if (root == 0) {
+        root = refOf(NODE4, nodes4.allocate());
+    }
+
+    // walk down, adding the missing children. A node moves when it grows,
+    // so the path keeps each node as it is once its child is in place.
+    uint32_t* slot = &root;
+    insertPath.clear();
+    for (char letter : word) {
+        unsigned char c = letter;
+        uint32_t* next = childSlot(*slot, c);
+        if (next == nullptr) {
+            uint32_t node = refOf(NODE4, nodes4.allocate());
+            addChild(*slot, c, node);
+            next = childSlot(*slot, c);
+        }
+        insertPath.push_back(*slot);
+        slot = next;
+    }
+    Header& last = header(*slot);
+    if (last.word != 0) {
+        // the word is already in the trie
+        return false;
+    }
+    last.word = words.add(word, freq);
+    insertPath.push_back(*slot);
+
+    // raise maxFreq bottom up, up to the first node high enough
+    while (!insertPath.empty()) {
+        Header& h = header(insertPath.back());
+        if (freq <= h.maxFreq) {
+            break;
+        }
+        h.maxFreq = freq;
+        insertPath.pop_back();
+    }
+    return true;
+}
+
+/* This is the function to find whether the word is in the trie.
+    arguments: the target word
+    return true if the word is found, false otherwise
+ */
+bool AdaptiveTrie::find(const string& word) const {
+    if (word.length() == 0 || root == 0) {
+        return false;
+    }
+    uint32_t ref = root;
+    for (char letter : word) {
+        ref = child(ref, (unsigned char)letter);
+        if (ref == 0) {
+            return false;
+        }
+    }
+    return header(ref).word != 0;
+}
+
+/* Use frequency to complete the predict completions.
+    arguments: prefix, number of completions return.
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> AdaptiveTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    uint32_t ref = root;
+    for (size_t i = 0; i < prefix.length() && ref != 0; i++) {
+        ref = child(ref, (unsigned char)prefix[i]);
+    }
+    if (ref != 0 && numCompletions > 0) {
+        collect(ref, numCompletions, heap);
+    }
+    return drain(heap);
+}
+
+/* function for wildcard prediction
+    arguments: pattern with (or without) underscore(s)
+                number of completions desired
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> AdaptiveTrie::predictUnderscores(
+    const string& pattern, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    if (root != 0 && pattern.length() > 0 && numCompletions > 0) {
+        matchPattern(root, pattern, 0, numCompletions, heap);
+    }
+    return drain(heap);
+}
+
+/* return: the number of nodes in the trie */
+size_t AdaptiveTrie::nodeCount() const {
+    return nodes4.size() + nodes16.size() + nodes48.size() + nodes256.size();
+}
+
+/* return: the number of nodes of each layout, smallest first */
+vector<size_t> AdaptiveTrie::layoutCounts() const {
+    return {nodes4.size(), nodes16.size(), nodes48.size(), nodes256.size()};
+}
+
+/* return: the number of bytes reserved for the nodes and the words */
+size_t AdaptiveTrie::memoryUsage() const {
+    return nodes4.bytesReserved() + nodes16.bytesReserved() +
+           nodes48.bytesReserved() + nodes256.bytesReserved() +
+           words.memoryUsage();
+}
+
+/* return: the fields shared by every layout of a node */
+AdaptiveTrie::Header& AdaptiveTrie::header(uint32_t ref) {
+    uint32_t index = ref & INDEX_MASK;
+    switch (layoutOf(ref)) {
+        case NODE4:
+            return nodes4[index].header;
+        case NODE16:
+            return nodes16[index].header;
+        case NODE48:
+            return nodes48[index].header;
+        default:
+            return nodes256[index].header;
+    }
+}
+
+/* return: the fields shared by every layout of a node */
+const AdaptiveTrie::Header& AdaptiveTrie::header(uint32_t ref) const {
+    return const_cast<AdaptiveTrie*>(this)->header(ref);
+}
+
+/* return: the slot holding the child of a node for a byte, or nullptr if
+    it has none
+ */
+uint32_t* AdaptiveTrie::childSlot(uint32_t ref, unsigned char c) {
+    uint32_t index = ref & INDEX_MASK;
+    switch (layoutOf(ref)) {
+        case NODE4: {
+            Node4& node = nodes4[index];
+            for (unsigned int i = 0; i < node.header.count; i++) {
+                if (node.keys[i] == c) {
+                    return &node.children[i];
+                }
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            Node16& node = nodes16[index];
+#if defined(__SSE2__)
+            // compare the byte with all 16 keys at once
+            __m128i keys = _mm_loadu_si128((const __m128i*)node.keys);
+            __m128i equal = _mm_cmpeq_epi8(keys, _mm_set1_epi8((char)c));
+            unsigned int hits = (unsigned int)_mm_movemask_epi8(equal) &
+                                ((1u << node.header.count) - 1);
+            if (hits != 0) {
+                return &node.children[__builtin_ctz(hits)];
+            }
+#else
+            for (unsigned int i = 0; i < node.header.count; i++) {
+                if (node.keys[i] == c) {
+                    return &node.children[i];
+                }
+            }
+#endif
+            return nullptr;
+        }
+        case NODE48: {
+            Node48& node = nodes48[index];
+            if (node.index[c] == 0) {
+                return nullptr;
+            }
+            return &node.children[node.index[c] - 1];
+        }
+        default: {
+            Node256& node = nodes256[index];
+            return node.children[c] == 0 ? nullptr : &node.children[c];
+        }
+    }
+}
+
+/* return: the child of a node for a byte, or 0 if it has none */
+uint32_t AdaptiveTrie::child(uint32_t ref, unsigned char c) const {
+    const uint32_t* slot = const_cast<AdaptiveTrie*>(this)->childSlot(ref, c);
+    return slot == nullptr ? 0 : *slot;
+}
+
+/* Add a child to a node, moving the node into the next layout first if it
+    is full.
+    arguments: the node, updated if it moves, the byte, the child
+ */
+void AdaptiveTrie::addChild(uint32_t& ref, unsigned char c, uint32_t node) {
+    static const unsigned int CAPACITY[] = {4, 16, 48, 256};
+    if (header(ref).count == CAPACITY[layoutOf(ref)]) {
+        ref = grow(ref);
+    }
+    uint32_t index = ref & INDEX_MASK;
+    switch (layoutOf(ref)) {
+        case NODE4:
+        case NODE16: {
+            // keep the keys sorted, shifting the larger ones up
+            Header& h = header(ref);
+            unsigned char* keys = layoutOf(ref) == NODE4
+                                      ? nodes4[index].keys
+                                      : nodes16[index].keys;
+            uint32_t* children = layoutOf(ref) == NODE4
+                                     ? nodes4[index].children
+                                     : nodes16[index].children;
+            unsigned int i = h.count;
+            while (i > 0 && keys[i - 1] > c) {
+                keys[i] = keys[i - 1];
+                children[i] = children[i - 1];
+                i--;
+            }
+            keys[i] = c;
+            children[i] = node;
+            h.count++;
+            break;
+        }
+        case NODE48: {
+            Node48& n = nodes48[index];
+            n.children[n.header.count] = node;
+            n.header.count++;
+            n.index[c] = (unsigned char)n.header.count;
+            break;
+        }
+        default: {
+            Node256& n = nodes256[index];
+            n.children[c] = node;
+            n.header.count++;
+        }
+    }
+}
+
+/* Move a full node into the next larger layout, releasing the old one.
+    return: the node in its new layout
+ */
+uint32_t AdaptiveTrie::grow(uint32_t ref) {
+    uint32_t index = ref & INDEX_MASK;
+    switch (layoutOf(ref)) {
+        case NODE4: {
+            const Node4& old = nodes4[index];
+            uint32_t bigger = nodes16.allocate();
+            Node16& n = nodes16[bigger];
+            n.header = old.header;
+            memcpy(n.keys, old.keys, sizeof(old.keys));
+            memcpy(n.children, old.children, sizeof(old.children));
+            nodes4.release(index);
+            return refOf(NODE16, bigger);
+        }
+        case NODE16: {
+            const Node16& old = nodes16[index];
+            uint32_t bigger = nodes48.allocate();
+            Node48& n = nodes48[bigger];
+            n.header = old.header;
+            for (unsigned int i = 0; i < old.header.count; i++) {
+                n.index[old.keys[i]] = (unsigned char)(i + 1);
+                n.children[i] = old.children[i];
+            }
+            nodes16.release(index);
+            return refOf(NODE48, bigger);
+        }
+        default: {
+            const Node48& old = nodes48[index];
+            uint32_t bigger = nodes256.allocate();
+            Node256& n = nodes256[bigger];
+            n.header = old.header;
+            for (unsigned int c = 0; c < 256; c++) {
+                if (old.index[c] != 0) {
+                    n.children[c] = old.children[old.index[c] - 1];
+                }
+            }
+            nodes48.release(index);
+            return refOf(NODE256, bigger);
+        }
+    }
+}
+
+/* Call visit(byte, child) for every child of a node, in byte order */
+template <typename Visit>
+void AdaptiveTrie::forEachChild(uint32_t ref, Visit visit) const {
+    uint32_t index = ref & INDEX_MASK;
+    switch (layoutOf(ref)) {
+        case NODE4: {
+            const Node4& node = nodes4[index];
+            for (unsigned int i = 0; i < node.header.count; i++) {
+                visit(node.keys[i], node.children[i]);
+            }
+            break;
+        }
+        case NODE16: {
+            const Node16& node = nodes16[index];
+            for (unsigned int i = 0; i < node.header.count; i++) {
+                visit(node.keys[i], node.children[i]);
+            }
+            break;
+        }
+        case NODE48: {
+            const Node48& node = nodes48[index];
+            for (unsigned int c = 0; c < 256; c++) {
+                if (node.index[c] != 0) {
+                    visit((unsigned char)c, node.children[node.index[c] - 1]);
+                }
+            }
+            break;
+        }
+        default: {
+            const Node256& node = nodes256[index];
+            for (unsigned int c = 0; c < 256; c++) {
+                if (node.children[c] != 0) {
+                    visit((unsigned char)c, node.children[c]);
+                }
+            }
+        }
+    }
+}
+
+/* return: true if word id1 comes before id2 in the completions: the
+    higher frequency first, then the word earlier in the alphabet
+ */
+bool AdaptiveTrie::betterWord(uint32_t id1, uint32_t id2) const {
+    unsigned int freq1 = words.freq(id1);
+    unsigned int freq2 = words.freq(id2);
+    if (freq1 != freq2) {
+        return freq1 > freq2;
+    }
+    return words.text(id1) < words.text(id2);
+}
+
+/* Offer a word to a heap of the best k words, the worst on top */
+void AdaptiveTrie::offerWord(uint32_t id, unsigned int k,
+                             vector<uint32_t>& heap) const {
+    auto better = [this](uint32_t id1, uint32_t id2) {
+        return betterWord(id1, id2);
+    };
+    if (heap.size() < k) {
+        heap.push_back(id);
+        push_heap(heap.begin(), heap.end(), better);
+    } else if (betterWord(id, heap.front())) {
+        pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = id;
+        push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+/* return: true if no word under a node with this maxFreq can enter a full
+    heap of the best k words
+ */
+bool AdaptiveTrie::prunes(unsigned int maxFreq, unsigned int k,
+                          const vector<uint32_t>& heap) const {
+    return heap.size() == k && maxFreq < words.freq(heap.front());
+}
+
+/* Turn a heap into the list of completions, best first */
+vector<string> AdaptiveTrie::drain(vector<uint32_t>& heap) const {
+    sort(heap.begin(), heap.end(), [this](uint32_t id1, uint32_t id2) {
+        return betterWord(id1, id2);
+    });
+    vector<string> results;
+    results.reserve(heap.size());
+    for (uint32_t id : heap) {
+        results.push_back(string(words.text(id)));
+    }
+    return results;
+}
+
+/* depth first top-k search of the subtree of a node, pruned by maxFreq */
+void AdaptiveTrie::collect(uint32_t ref, unsigned int k,
+                           vector<uint32_t>& heap) const {
+    const Header& h = header(ref);
+    if (prunes(h.maxFreq, k, heap)) {
+        return;
+    }
+    if (h.word != 0) {
+        offerWord(h.word, k, heap);
+    }
+    forEachChild(ref, [&](unsigned char, uint32_t next) {
+        collect(next, k, heap);
+    });
+}
+
+/* match pattern[pos..] against the subtree of a node */
+void AdaptiveTrie::matchPattern(uint32_t ref, const string& pattern,
+                                size_t pos, unsigned int k,
+                                vector<uint32_t>& heap) const {
+    const Header& h = header(ref);
+    if (prunes(h.maxFreq, k, heap)) {
+        return;
+    }
+    if (pos == pattern.length()) {
+        if (h.word != 0) {
+            offerWord(h.word, k, heap);
+        }
+        return;
+    }
+    if (pattern[pos] == '_') {
+        forEachChild(ref, [&](unsigned char, uint32_t next) {
+            matchPattern(next, pattern, pos + 1, k, heap);
+        });
+    } else {
+        uint32_t next = child(ref, (unsigned char)pattern[pos]);
+        if (next != 0) {
+            matchPattern(next, pattern, pos + 1, k, heap);
+        }
+    }
+}
@@ -0,0 +1,215 @@
+/**
+ * This file declares the structure of AdaptiveTrie class, a trie whose
+ * nodes change their layout with the number of their children.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef ADAPTIVE_TRIE_HPP
+#define ADAPTIVE_TRIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "NodeArena.hpp"
+#include "WordPool.hpp"
+
+using namespace std;
+
+/**
+ * An adaptive radix trie (ART) over the bytes of the words, another engine
+ * behind the same insert, find and predict interface as DictionaryTrie.
+ * Every node has one child per next byte, found in one of four layouts,
+ * the smallest that fits:
+ *   Node4    up to 4 children, the bytes in a sorted array
+ *   Node16   up to 16 children, the bytes in a sorted array matched all at
+ *            once with one SSE2 compare
+ *   Node48   up to 48 children, a 256-entry byte index into the children
+ *   Node256  a child pointer for every byte
+ * so a step down reads one node, instead of a chain of left and right
+ * siblings, and a node grows into the next layout when it fills up.
+ * Children are listed in byte order, so walks visit the words in
+ * alphabetical order. Every node keeps the largest frequency below it,
+ * which prunes the top-k searches as in DictionaryTrie.
+ * The trie is for one thread at a time.
+ */
+class AdaptiveTrie {
+  private:
+    /** the fields shared by every layout */
+    struct Header {
+        // the id of the word ending at this node, 0 if none
+        uint32_t word;
+        // the largest frequency of the words at and below this node
+        unsigned int maxFreq;
+        // the number of children
+        uint16_t count;
+
+        Header() : word(0), maxFreq(0), count(0) {}
+    };
+
+    /** a node of up to 4 children, bytes sorted */
+    struct Node4 {
+        Header header;
+        unsigned char keys[4];
+        uint32_t children[4];
+    };
+
+    /** a node of up to 16 children, bytes sorted */
+    struct Node16 {
+        Header header;
+        unsigned char keys[16];
+        uint32_t children[16];
+    };
+
+    /** a node of up to 48 children, reached through a byte index */
+    struct Node48 {
+        Header header;
+        // the child of byte c is children[index[c] - 1], none if 0
+        unsigned char index[256];
+        uint32_t children[48];
+
+        Node48();
+    };
+
+    /** a node with a child slot for every byte */
+    struct Node256 {
+        Header header;
+        uint32_t children[256];
+
+        Node256();
+    };
+
+    /** the layout of a node, kept in the top bits of its reference */
+    enum Layout { NODE4, NODE16, NODE48, NODE256 };
+
+    // a node is named by its layout and its index in the arena of that
+    // layout, as (layout << LAYOUT_SHIFT) | index. 0 is no node.
+    static const unsigned int LAYOUT_SHIFT = 30;
+    static const uint32_t INDEX_MASK = (uint32_t(1) << LAYOUT_SHIFT) - 1;
+
+    NodeArena<Node4> nodes4;
+    NodeArena<Node16> nodes16;
+    NodeArena<Node48> nodes48;
+    NodeArena<Node256> nodes256;
+
+    // the node of the empty prefix, 0 if empty trie
+    uint32_t root;
+
+    // the id, text and frequency of every word
+    WordPool words;
+
+    // scratch list of the nodes on the path of an insert
+    vector<uint32_t> insertPath;
+
+  public:
+    /* It is the constructor */
+    AdaptiveTrie();
+
+    AdaptiveTrie(const AdaptiveTrie&) = delete;
+    AdaptiveTrie& operator=(const AdaptiveTrie&) = delete;
+
+    /* Insert a word with its frequency into the trie.
+        arguments: the word, its frequency
+        return: true if the word was inserted, false if it is empty or
+        already in the trie
+     */
+    bool insert(string_view word, unsigned int freq);
+
+    /* This is the function to find whether the word is in the trie.
+        arguments: the target word
+        return true if the word is found, false otherwise
+     */
+    bool find(const string& word) const;
+
+    /* Use frequency to complete the predict completions.
+        arguments: prefix, number of completions return.
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* function for wildcard prediction
+        arguments: pattern with (or without) underscore(s)
+                    number of completions desired
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const;
+
+    /* return: the number of nodes in the trie */
+    size_t nodeCount() const;
+
+    /* return: the number of nodes of each layout, smallest first */
+    vector<size_t> layoutCounts() const;
+
+    /* return: the number of bytes reserved for the nodes and the words */
+    size_t memoryUsage() const;
+
+  private:
+    /* return: the reference of a node of a layout */
+    static uint32_t refOf(Layout layout, uint32_t index) {
+        return (uint32_t(layout) << LAYOUT_SHIFT) | index;
+    }
+
+    /* return: the layout of a node */
+    static Layout layoutOf(uint32_t ref) {
+        return Layout(ref >> LAYOUT_SHIFT);
+    }
+
+    /* return: the fields shared by every layout of a node */
+    Header& header(uint32_t ref);
+    const Header& header(uint32_t ref) const;
+
+    /* return: the slot holding the child of a node for a byte, or nullptr
+        if it has none
+     */
+    uint32_t* childSlot(uint32_t ref, unsigned char c);
+
+    /* return: the child of a node for a byte, or 0 if it has none */
+    uint32_t child(uint32_t ref, unsigned char c) const;
+
+    /* Add a child to a node, moving the node into the next layout first
+        if it is full.
+        arguments: the node, updated if it moves, the byte, the child
+     */
+    void addChild(uint32_t& ref, unsigned char c, uint32_t node);
+
+    /* Move a full node into the next larger layout, releasing the old
+        one.
+        return: the node in its new layout
+     */
+    uint32_t grow(uint32_t ref);
+
+    /* Call visit(byte, child) for every child of a node, in byte order */
+    template <typename Visit>
+    void forEachChild(uint32_t ref, Visit visit) const;
+
+    /* return: true if word id1 comes before id2 in the completions: the
+        higher frequency first, then the word earlier in the alphabet
+     */
+    bool betterWord(uint32_t id1, uint32_t id2) const;
+
+    /* Offer a word to a heap of the best k words, the worst on top */
+    void offerWord(uint32_t id, unsigned int k, vector<uint32_t>& heap) const;
+
+    /* return: true if no word under a node with this maxFreq can enter a
+        full heap of the best k words
+     */
+    bool prunes(unsigned int maxFreq, unsigned int k,
+                const vector<uint32_t>& heap) const;
+
+    /* Turn a heap into the list of completions, best first */
+    vector<string> drain(vector<uint32_t>& heap) const;
+
+    /* depth first top-k search of the subtree of a node, pruned by
+        maxFreq
+     */
+    void collect(uint32_t ref, unsigned int k, vector<uint32_t>& heap) const;
+
+    /* match pattern[pos..] against the subtree of a node */
+    void matchPattern(uint32_t ref, const string& pattern, size_t pos,
+                      unsigned int k, vector<uint32_t>& heap) const;
+};
+
+#endif  // ADAPTIVE_TRIE_HPP
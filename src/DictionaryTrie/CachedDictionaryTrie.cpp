@@ -0,0 +1,232 @@
+/**
+ * This File shows the implementation details of
+ * CachedDictionaryTrie class methods, which are declared
+ * in "CachedDictionaryTrie.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "CachedDictionaryTrie.hpp"
+
+/* It is the constructor */
+CachedDictionaryTrie::CachedDictionaryTrie(DictionaryTrie& trie,
+                                           size_t capacity)
+    : trie(trie), capacity(capacity), numHits(0), numMisses(0) {}
+
+/* Insert the word into the trie and drop the cached results that could
+    hold it.
+    arguments: word to insert, frequency of that word
+    return: true if insertion is successful, false otherwise
+ */
+bool CachedDictionaryTrie::insert(string_view word, unsigned int freq) {
+    unique_lock<shared_mutex> writing(trieLock);
+    if (!trie.insert(word, freq)) {
+        return false;
+    }
+    dropWord(word);
+    return true;
+}
+
+/* DictionaryTrie::upsert, dropping the cached results that could hold the
+    word
+ */
+bool CachedDictionaryTrie::upsert(string_view word, unsigned int freq) {
+    unique_lock<shared_mutex> writing(trieLock);
+    bool inserted = trie.upsert(word, freq);
+    dropWord(word);
+    return inserted;
+}
+
+/* DictionaryTrie::addFrequency, dropping the cached results that could
+    hold the word
+ */
+bool CachedDictionaryTrie::addFrequency(string_view word, long long delta) {
+    unique_lock<shared_mutex> writing(trieLock);
+    if (!trie.addFrequency(word, delta)) {
+        return false;
+    }
+    dropWord(word);
+    return true;
+}
+
+/* DictionaryTrie::addFrequencies, dropping every cached result */
+size_t CachedDictionaryTrie::addFrequencies(
+    const vector<pair<string_view, long long>>& deltas) {
+    unique_lock<shared_mutex> writing(trieLock);
+    size_t applied = trie.addFrequencies(deltas);
+    clear();
+    return applied;
+}
+
+/* DictionaryTrie::erase, dropping the cached results that could hold the
+    word
+ */
+bool CachedDictionaryTrie::erase(string_view word) {
+    unique_lock<shared_mutex> writing(trieLock);
+    if (!trie.erase(word)) {
+        return false;
+    }
+    dropWord(word);
+    return true;
+}
+
+/* DictionaryTrie::eraseAll, dropping every cached result */
+size_t CachedDictionaryTrie::eraseAll(const vector<string_view>& texts) {
+    unique_lock<shared_mutex> writing(trieLock);
+    size_t erased = trie.eraseAll(texts);
+    clear();
+    return erased;
+}
+
+/* Drop the cached results that could hold the word */
+void CachedDictionaryTrie::dropWord(string_view word) {
+    lock_guard<mutex> guard(cacheLock);
+    // the completions of every prefix, from the empty one to the word
+    string key = "c";
+    drop(key);
+    for (char letter : word) {
+        key.push_back(letter);
+        drop(key);
+    }
+    // the patterns of the same length that match the word
+    list<Entry>::iterator it = entries.begin();
+    while (it != entries.end()) {
+        const string& pattern = it->key;
+        bool matches =
+            pattern[0] == 'u' && pattern.length() == word.length() + 1;
+        for (size_t i = 0; matches && i < word.length(); i++) {
+            matches = pattern[i + 1] == '_' || pattern[i + 1] == word[i];
+        }
+        if (matches) {
+            index.erase(pattern);
+            it = entries.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+/* DictionaryTrie::predictCompletions, answered from the cache when
+    possible
+ */
+vector<string> CachedDictionaryTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) {
+    return query("c" + prefix, prefix, numCompletions);
+}
+
+/* DictionaryTrie::predictUnderscores, answered from the cache when
+    possible
+ */
+vector<string> CachedDictionaryTrie::predictUnderscores(
+    const string& pattern, unsigned int numCompletions) {
+    return query("u" + pattern, pattern, numCompletions);
+}
+
+/* Drop every cached result. The counters are kept. */
+void CachedDictionaryTrie::clear() {
+    lock_guard<mutex> guard(cacheLock);
+    entries.clear();
+    index.clear();
+}
+
+/* return: the number of queries answered from the cache */
+size_t CachedDictionaryTrie::hits() {
+    lock_guard<mutex> guard(cacheLock);
+    return numHits;
+}
+
+/* return: the number of queries that went to the trie */
+size_t CachedDictionaryTrie::misses() {
+    lock_guard<mutex> guard(cacheLock);
+    return numMisses;
+}
+
+/* return: the number of cached results */
+size_t CachedDictionaryTrie::size() {
+    lock_guard<mutex> guard(cacheLock);
+    return entries.size();
+}
+
+/* Look the query up and, on a miss, run it on the trie and cache it.
+    arguments: the cache key, the query text, number of completions
+    return: the results of the query
+ */
+vector<string> CachedDictionaryTrie::query(const string& key,
+                                           const string& text,
+                                           unsigned int numCompletions) {
+    vector<string> results;
+    if (numCompletions == 0) {
+        return results;
+    }
+    {
+        lock_guard<mutex> guard(cacheLock);
+        unordered_map<string, list<Entry>::iterator>::iterator it =
+            index.find(key);
+        if (it != index.end() && answer(*it->second, numCompletions, results)) {
+            // move the entry to the front
+            entries.splice(entries.begin(), entries, it->second);
+            numHits++;
+            return results;
+        }
+        numMisses++;
+    }
+
+    // the trie stays locked until the result is cached, so that no insert
+    // can slip in between and leave a stale result behind
+    shared_lock<shared_mutex> reading(trieLock);
+    if (key[0] == 'c') {
+        results = trie.predictCompletions(text, numCompletions);
+    } else {
+        results = trie.predictUnderscores(text, numCompletions);
+    }
+
+    lock_guard<mutex> guard(cacheLock);
+    if (capacity == 0) {
+        return results;
+    }
+    unordered_map<string, list<Entry>::iterator>::iterator it =
+        index.find(key);
+    if (it != index.end()) {
+        // another thread cached the same query meanwhile, keep the larger
+        if (it->second->k < numCompletions) {
+            it->second->k = numCompletions;
+            it->second->results = results;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return results;
+    }
+    entries.push_front(Entry{key, numCompletions, results});
+    index[key] = entries.begin();
+    if (entries.size() > capacity) {
+        // evict the least recently used result
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    return results;
+}
+
+/* Copy the first numCompletions results of the entry if they answer the
+    request.
+    return: true if they do
+ */
+bool CachedDictionaryTrie::answer(const Entry& entry,
+                                  unsigned int numCompletions,
+                                  vector<string>& results) {
+    bool complete = entry.results.size() < entry.k;
+    if (numCompletions > entry.k && !complete) {
+        return false;
+    }
+    size_t count = min((size_t)numCompletions, entry.results.size());
+    results.assign(entry.results.begin(), entry.results.begin() + count);
+    return true;
+}
+
+/* Drop the entry with the given key if it is cached */
+void CachedDictionaryTrie::drop(const string& key) {
+    unordered_map<string, list<Entry>::iterator>::iterator it =
+        index.find(key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * This file declares the structure of CachedDictionaryTrie class, a
+ * DictionaryTrie with a bounded cache of recent query results.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef CACHED_DICTIONARY_TRIE_HPP
+#define CACHED_DICTIONARY_TRIE_HPP
+
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * Puts a least recently used cache in front of the queries of a
+ * DictionaryTrie. Results are kept per prefix or pattern: a result cached
+ * for k completions also answers any request for fewer.
+ * Every method may be called from several threads at once. Queries share
+ * the trie, and the methods that change it take it alone and drop the
+ * cached results they could change, so while the cache is in use the trie
+ * must only be changed through it.
+ */
+class CachedDictionaryTrie {
+  private:
+    /** a cached result */
+    struct Entry {
+        // 'c' for completions or 'u' for underscores, then the prefix or
+        // pattern
+        string key;
+        // the numCompletions the results were computed for
+        unsigned int k;
+        // best first; fewer than k means every match is in the list
+        vector<string> results;
+    };
+
+    DictionaryTrie& trie;
+    // taken shared by queries and alone by insert
+    shared_mutex trieLock;
+
+    // guards everything below
+    mutex cacheLock;
+    // the max number of cached results
+    size_t capacity;
+    // most recently used first
+    list<Entry> entries;
+    unordered_map<string, list<Entry>::iterator> index;
+    size_t numHits;
+    size_t numMisses;
+
+  public:
+    /* It is the constructor.
+        arguments: the trie to query, the max number of cached results
+     */
+    CachedDictionaryTrie(DictionaryTrie& trie, size_t capacity);
+
+    CachedDictionaryTrie(const CachedDictionaryTrie&) = delete;
+    CachedDictionaryTrie& operator=(const CachedDictionaryTrie&) = delete;
+
+    /* Insert the word into the trie and drop the cached results that
+        could hold it: the completions of each of its prefixes and the
+        patterns of its length that match it.
+        arguments: word to insert, frequency of that word
+        return: true if insertion is successful, false otherwise
+     */
+    bool insert(string_view word, unsigned int freq);
+
+    /* DictionaryTrie::upsert, dropping the cached results that could hold
+        the word, like insert
+     */
+    bool upsert(string_view word, unsigned int freq);
+
+    /* DictionaryTrie::addFrequency, dropping the cached results that could
+        hold the word, like insert
+     */
+    bool addFrequency(string_view word, long long delta);
+
+    /* DictionaryTrie::addFrequencies, dropping every cached result */
+    size_t addFrequencies(const vector<pair<string_view, long long>>& deltas);
+
+    /* DictionaryTrie::erase, dropping the cached results that could hold
+        the word, like insert
+     */
+    bool erase(string_view word);
+
+    /* DictionaryTrie::eraseAll, dropping every cached result */
+    size_t eraseAll(const vector<string_view>& texts);
+
+    /* DictionaryTrie::predictCompletions, answered from the cache when
+        possible
+     */
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions);
+
+    /* DictionaryTrie::predictUnderscores, answered from the cache when
+        possible
+     */
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions);
+
+    /* Drop every cached result. The counters are kept. */
+    void clear();
+
+    /* return: the number of queries answered from the cache */
+    size_t hits();
+
+    /* return: the number of queries that went to the trie */
+    size_t misses();
+
+    /* return: the number of cached results */
+    size_t size();
+
+  private:
+    /* Look the query up and, on a miss, run it on the trie and cache it.
+        arguments: the cache key, the query text, number of completions
+        return: the results of the query
+     */
+    vector<string> query(const string& key, const string& text,
+                         unsigned int numCompletions);
+
+    /* Copy the first numCompletions results of the entry if they answer
+        the request.
+        return: true if they do
+     */
+    static bool answer(const Entry& entry, unsigned int numCompletions,
+                       vector<string>& results);
+
+    /* Drop the entry with the given key if it is cached */
+    void drop(const string& key);
+
+    /* Drop the cached results that could hold the word: the completions
+        of each of its prefixes and the patterns of its length that match
+        it
+     */
+    void dropWord(string_view word);
+};
+
+#endif  // CACHED_DICTIONARY_TRIE_HPP
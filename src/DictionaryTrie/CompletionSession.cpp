@@ -0,0 +1,105 @@
+/**
+ * This File shows the implementation details of
+ * CompletionSession class methods, which are declared
+ * in "CompletionSession.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "CompletionSession.hpp"
+
+/* It is the constructor. The session starts with the empty prefix */
+CompletionSession::CompletionSession(const DictionaryTrie& trie)
+    : trie(trie),
+      seenNodes(trie.nodeCount()),
+      seenErased(trie.words.erasedCount()) {}
+
+/* Type a letter at the end of the prefix */
+void CompletionSession::push(char letter) {
+    refresh();
+    text.push_back(letter);
+    path.push_back(lookUp(path.size()));
+}
+
+/* Remove the last letter of the prefix, if there is one */
+void CompletionSession::pop() {
+    if (!path.empty()) {
+        text.pop_back();
+        path.pop_back();
+    }
+}
+
+/* Clear the prefix */
+void CompletionSession::reset() {
+    text.clear();
+    path.clear();
+}
+
+/* return: the prefix typed so far */
+const string& CompletionSession::prefix() const { return text; }
+
+/* return: true if some word of the trie starts with the prefix */
+bool CompletionSession::alive() {
+    refresh();
+    if (path.empty()) {
+        return trie.root != 0;
+    }
+    return path.back() != 0;
+}
+
+/* Complete the prefix typed so far.
+    arguments: number of completions
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> CompletionSession::complete(unsigned int numCompletions) {
+    vector<string> results;
+    complete(numCompletions, results);
+    return results;
+}
+
+/* Complete the prefix typed so far into a list owned by the caller, whose
+    strings are reused.
+    arguments: number of completions, the list of completions, sorted by
+    their frequency
+ */
+void CompletionSession::complete(unsigned int numCompletions,
+                                 vector<string>& results) {
+    if (!alive()) {
+        results.clear();
+        return;
+    }
+    uint32_t ptr = path.empty() ? trie.root.load() : path.back();
+    trie.completeFrom(ptr, text, numCompletions, results);
+}
+
+/* return: the node of letter i, looked up from the node before it */
+uint32_t CompletionSession::lookUp(size_t i) const {
+    uint32_t chain = trie.root;
+    if (i > 0) {
+        if (path[i - 1] == 0) {
+            // a dead prefix stays dead
+            return 0;
+        }
+        chain = trie.nodes[path[i - 1]].mid;
+    }
+    return trie.findLetter(chain, text[i]);
+}
+
+/* Look the dead letters up again if the trie has grown since. Inserts
+    never remove nodes, so the letters that were found stay valid, but an
+    erase may have unlinked any of them, and then every letter is looked
+    up again.
+ */
+void CompletionSession::refresh() {
+    bool erased = seenErased != trie.words.erasedCount();
+    if (seenNodes == trie.nodeCount() && !erased) {
+        return;
+    }
+    seenNodes = trie.nodeCount();
+    seenErased = trie.words.erasedCount();
+    for (size_t i = 0; i < path.size(); i++) {
+        if (erased || path[i] == 0) {
+            path[i] = lookUp(i);
+        }
+    }
+}
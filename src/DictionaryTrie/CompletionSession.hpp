@@ -0,0 +1,84 @@
+/**
+ * This file declares the structure of CompletionSession class, which
+ * completes a prefix typed one keystroke at a time.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef COMPLETION_SESSION_HPP
+#define COMPLETION_SESSION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * Follows a prefix as it is typed into a DictionaryTrie. The session
+ * keeps the node of every letter typed so far, so a keystroke only
+ * searches one sibling chain and a backspace is free, instead of
+ * descending from the root for every call to predictCompletions.
+ * Once the prefix leaves the trie it is dead, and further keystrokes
+ * cost nothing until it is backspaced into the trie again.
+ * Words inserted into or erased from the trie during the session are
+ * seen by it.
+ */
+class CompletionSession {
+  private:
+    const DictionaryTrie& trie;
+    string text;
+    // the node of each letter of the prefix, 0 from the first letter
+    // that is not in the trie on
+    vector<uint32_t> path;
+    // the number of trie nodes and of erased words when the letters were
+    // last looked up
+    size_t seenNodes;
+    size_t seenErased;
+
+  public:
+    /* It is the constructor. The session starts with the empty prefix */
+    explicit CompletionSession(const DictionaryTrie& trie);
+
+    /* Type a letter at the end of the prefix */
+    void push(char letter);
+
+    /* Remove the last letter of the prefix, if there is one */
+    void pop();
+
+    /* Clear the prefix */
+    void reset();
+
+    /* return: the prefix typed so far */
+    const string& prefix() const;
+
+    /* return: true if some word of the trie starts with the prefix */
+    bool alive();
+
+    /* Complete the prefix typed so far.
+        arguments: number of completions
+        return: a list of completions, sorted by their frequency, the same
+        as predictCompletions(prefix(), numCompletions)
+     */
+    vector<string> complete(unsigned int numCompletions);
+
+    /* Complete the prefix typed so far into a list owned by the caller,
+        whose strings are reused, like the buffer form of
+        predictCompletions.
+        arguments: number of completions, the list of completions, sorted
+        by their frequency
+     */
+    void complete(unsigned int numCompletions, vector<string>& results);
+
+  private:
+    /* return: the node of letter i, looked up from the node before it */
+    uint32_t lookUp(size_t i) const;
+
+    /* Look the dead letters up again if the trie has grown since, and
+        every letter if a word was erased
+     */
+    void refresh();
+};
+
+#endif  // COMPLETION_SESSION_HPP
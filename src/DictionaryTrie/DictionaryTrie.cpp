@@ -7,249 +7,1108 @@
  * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
  */
 #include "DictionaryTrie.hpp"
+#include <climits>
 #include <iostream>
+#include "WorkPool.hpp"
+
+/* return: the root table entry of the first two letters of the word */
+static size_t pairSlot(string_view word) {
+    return (unsigned char)word[0] * 256 + (unsigned char)word[1];
+}
 
 /* It is the constructor*/
-DictionaryTrie::DictionaryTrie() { root = 0; }
+DictionaryTrie::DictionaryTrie() : firstNodes(256), secondNodes(256 * 256) {
+    root = 0;
+    rootTable = true;
+    topKSearch = DEPTH_FIRST;
+    patternSearch = PLANNED;
+    patternIndexFresh = false;
+    topK.k = 0;
+    topK.maxDepth = 0;
+}
 
 /* This is the function to insert the word into the trie.
     arguments: word to insert, frequency of that word
     return: true if insertion is successful, false otherwise
  */
-bool DictionaryTrie::insert(string word, unsigned int freq) {
+bool DictionaryTrie::insert(string_view word, unsigned int freq) {
     if (word.length() == 0) {
         return false;
     }
 
-    Node* ptr;
-    char letter = word[0];
-    int i = 1;
-    if (root == 0) {
-        root = new Node(letter);
-        ptr = root;
-    } else {
-        ptr = root;
-        while (true) {
-            if (letter < ptr->letter) {
-                // search the left subtree
-                if (ptr->left != nullptr) {
-                    ptr = ptr->left;
-                } else {
-                    // not found, create new left child
-                    ptr->left = new Node(letter);
-                    ptr->left->parent = ptr;
-                    ptr = ptr->left;
-                    break;
-                }
-            } else if (letter > ptr->letter) {
-                // search the right subtree
-                if (ptr->right != nullptr) {
-                    ptr = ptr->right;
-                } else {
-                    // not found, create new right child
-                    ptr->right = new Node(letter);
-                    ptr->right->parent = ptr;
-                    ptr = ptr->right;
-                    break;
-                }
-            } else {
-                // search the middle tree
-                if (i == word.length()) {
-                    if (ptr->is_word) {
-                        // the word is already in the trie
-                        return false;
-                    } else {
-                        // the word is not in the trie. mark it as 'word'
-                        ptr->is_word = true;
-                        ptr->freq = freq;
-                        while (ptr != nullptr) {
-                            if (freq > ptr->maxFreq) {
-                                ptr->maxFreq = freq;
-                            } else {
-                                break;
-                            }
-                            ptr = ptr->parent;
-                        }
-                        return true;
-                    }
-                } else {
-                    // next letter
-                    letter = word[i];
-                    i++;
-                    if (ptr->mid != nullptr) {
-                        ptr = ptr->mid;
-                    } else {
-                        // not found, create new mid node
-                        ptr->mid = new Node(letter);
-                        ptr->mid->parent = ptr;
-                        ptr = ptr->mid;
-                        break;
-                    }
-                }
+    // walk down to the link where the word leaves the trie, keeping every
+    // node visited for the maxFreq update. This is the only writer, so
+    // its own stores need no ordering.
+    atomic<uint32_t>* link = &root;
+    size_t i = 0;
+    insertPath.clear();
+    uint32_t ptr = root.load(memory_order_relaxed);
+    // start below the top sibling chains if the root table has a node of
+    // the word
+    uint32_t start = rootTable ? shortcut(word, i) : 0;
+    if (start != 0) {
+        ptr = start;
+    }
+    while (ptr != 0) {
+        Node& node = nodes[ptr];
+        insertPath.push_back(ptr);
+        if (word[i] < node.letter) {
+            // search the left subtree
+            link = &node.left;
+        } else if (word[i] > node.letter) {
+            // search the right subtree
+            link = &node.right;
+        } else if (i + 1 == word.length()) {
+            if (node.word.load(memory_order_relaxed) != 0) {
+                // the word is already in the trie
+                return false;
+            }
+            // the word ends at this node. mark it as 'word', after its
+            // text and frequency are in place
+            raiseMaxFreq(freq);
+            raiseAbove(word, start, freq);
+            uint32_t id = words.add(word, freq);
+            patternIndexFresh = false;
+            node.word.store(id, memory_order_release);
+            if (topK.k > 0) {
+                updatePrecomputed(word, id);
             }
+            return true;
+        } else {
+            // search the middle tree with the next letter
+            link = &node.mid;
+            i++;
         }
+        ptr = link->load(memory_order_relaxed);
     }
 
-    // loop through the word, create new mid nodes for the rest letters
-    while (i < word.length()) {
-        letter = word[i];
-        i++;
-        ptr->mid = new Node(letter);
-        ptr->mid->parent = ptr;
-        ptr = ptr->mid;
-    }
-    // set the last letter as 'word'. store its frequency
-    ptr->is_word = true;
-    ptr->freq = freq;
-    while (ptr != nullptr) {
-        if (freq > ptr->maxFreq) {
-            ptr->maxFreq = freq;
+    // create a chain of mid nodes for the rest letters, not yet linked
+    size_t headDepth = i;
+    uint32_t head = nodes.allocate(word[i]);
+    uint32_t last = head;
+    nodes[head].maxFreq.store(freq, memory_order_relaxed);
+    for (i++; i < word.length(); i++) {
+        uint32_t child = nodes.allocate(word[i]);
+        nodes[child].maxFreq.store(freq, memory_order_relaxed);
+        nodes[last].mid.store(child, memory_order_relaxed);
+        last = child;
+    }
+    // set the last letter as 'word'. store its text and frequency
+    uint32_t id = words.add(word, freq);
+    nodes[last].word.store(id, memory_order_relaxed);
+    raiseMaxFreq(freq);
+    raiseAbove(word, start, freq);
+    patternIndexFresh = false;
+    // publish the whole chain at once
+    link->store(head, memory_order_release);
+    if (headDepth == 0) {
+        firstNodes[(unsigned char)word[0]].store(head, memory_order_release);
+    }
+    if (headDepth <= 1 && word.length() > 1) {
+        uint32_t second = headDepth == 0 ? nodes[head].mid.load() : head;
+        secondNodes[pairSlot(word)].store(second, memory_order_release);
+    }
+    if (topK.k > 0) {
+        updatePrecomputed(word, id);
+    }
+    return true;
+}
+
+/* helper method for insert. Raises the maxFreq of the nodes in insertPath
+    to freq where it is lower. A node's maxFreq is never below the ones
+    under it, so the walk back up stops at the first node high enough.
+ */
+void DictionaryTrie::raiseMaxFreq(unsigned int freq) {
+    while (!insertPath.empty()) {
+        Node& node = nodes[insertPath.back()];
+        if (freq > node.maxFreq.load(memory_order_relaxed)) {
+            node.maxFreq.store(freq, memory_order_relaxed);
         } else {
             break;
         }
-        ptr = ptr->parent;
+        insertPath.pop_back();
+    }
+}
+
+/* return: the node of letter word[depth], found in the root table, where
+    depth is 1 if the table has the first two letters of the word and 0 if
+    it only has the first; 0 if it has neither
+ */
+uint32_t DictionaryTrie::shortcut(string_view word, size_t& depth) const {
+    if (word.length() > 1) {
+        uint32_t second =
+            secondNodes[pairSlot(word)].load(memory_order_acquire);
+        if (second != 0) {
+            depth = 1;
+            return second;
+        }
+    }
+    depth = 0;
+    return firstNodes[(unsigned char)word[0]].load(memory_order_acquire);
+}
+
+/* helper method for insert. Raises the maxFreq of the nodes above start,
+    which the root table skipped, where it is lower. Only a raise that
+    got past start has to walk the top chains again.
+    arguments: the word, the node insert started from, the frequency
+ */
+void DictionaryTrie::raiseAbove(string_view word, uint32_t start,
+                                unsigned int freq) {
+    if (start == 0 || !insertPath.empty()) {
+        return;
+    }
+    uint32_t ptr = root.load(memory_order_relaxed);
+    size_t i = 0;
+    while (ptr != start) {
+        const Node& node = nodes[ptr];
+        insertPath.push_back(ptr);
+        if (word[i] < node.letter) {
+            ptr = node.left.load(memory_order_relaxed);
+        } else if (word[i] > node.letter) {
+            ptr = node.right.load(memory_order_relaxed);
+        } else {
+            ptr = node.mid.load(memory_order_relaxed);
+            i++;
+        }
+    }
+    raiseMaxFreq(freq);
+}
+
+/* Set the root table entries of the first two letters of the word from the
+    trie, after they may have been unlinked.
+ */
+void DictionaryTrie::refreshRootTable(string_view word) {
+    uint32_t first = findLetter(root, word[0]);
+    firstNodes[(unsigned char)word[0]].store(first, memory_order_release);
+    if (word.length() > 1) {
+        uint32_t second =
+            first == 0 ? 0 : findLetter(nodes[first].mid, word[1]);
+        secondNodes[pairSlot(word)].store(second, memory_order_release);
+    }
+}
+
+/* Record every node of the top two sibling chains in the root table.
+    arguments: the root of the chain, its first letter above it, or -1 for
+    the top chain
+ */
+void DictionaryTrie::fillRootTable(uint32_t ptr, int first) {
+    if (ptr == 0) {
+        return;
+    }
+    const Node& node = nodes[ptr];
+    unsigned char letter = node.letter;
+    if (first < 0) {
+        firstNodes[letter].store(ptr, memory_order_release);
+        fillRootTable(node.mid, letter);
+    } else {
+        secondNodes[first * 256 + letter].store(ptr, memory_order_release);
+    }
+    fillRootTable(node.left, first);
+    fillRootTable(node.right, first);
+}
+
+/* helper method for upsert and addFrequency. Finds a word, keeping every
+    node visited in insertPath.
+    return: the id of the word, or 0 if it is not in the trie
+ */
+uint32_t DictionaryTrie::findPath(string_view word) {
+    insertPath.clear();
+    uint32_t ptr = root.load(memory_order_relaxed);
+    size_t i = 0;
+    while (ptr != 0 && i < word.length()) {
+        const Node& node = nodes[ptr];
+        insertPath.push_back(ptr);
+        if (word[i] < node.letter) {
+            ptr = node.left.load(memory_order_relaxed);
+        } else if (word[i] > node.letter) {
+            ptr = node.right.load(memory_order_relaxed);
+        } else if (i + 1 == word.length()) {
+            return node.word.load(memory_order_relaxed);
+        } else {
+            ptr = node.mid.load(memory_order_relaxed);
+            i++;
+        }
+    }
+    return 0;
+}
+
+/* Insert the word, or set its frequency if it is already in the trie.
+    arguments: the word, its frequency
+    return: true if the word was inserted, false otherwise
+ */
+bool DictionaryTrie::upsert(string_view word, unsigned int freq) {
+    uint32_t id = findPath(word);
+    if (id == 0) {
+        return insert(word, freq);
+    }
+    setFrequency(word, id, freq);
+    return false;
+}
+
+/* Add delta, which may be negative, to the frequency of a word in the
+    trie. The frequency stays between 0 and UINT_MAX.
+    arguments: the word, the change of its frequency
+    return: true if the word is in the trie
+ */
+bool DictionaryTrie::addFrequency(string_view word, long long delta) {
+    uint32_t id = findPath(word);
+    if (id == 0) {
+        return false;
+    }
+    setFrequency(word, id, addClamped(words.freq(id), delta));
+    return true;
+}
+
+/* Apply many frequency changes at once, then recompute maxFreq and the
+    precomputed lists once.
+    arguments: pairs of word and change of its frequency
+    return: the number of deltas applied
+ */
+size_t DictionaryTrie::addFrequencies(
+    const vector<pair<string_view, long long>>& deltas) {
+    size_t applied = 0;
+    for (const pair<string_view, long long>& delta : deltas) {
+        uint32_t id = wordId(delta.first);
+        if (id != 0) {
+            words.setFreq(id, addClamped(words.freq(id), delta.second));
+            applied++;
+        }
+    }
+    if (applied > 0) {
+        repairFrequencies();
+    }
+    return applied;
+}
+
+/* Apply many frequency changes at once, to the words with the given ids.
+    arguments: pairs of word id and change of its frequency
+    return: the number of deltas applied
+ */
+size_t DictionaryTrie::addFrequencies(
+    const vector<pair<uint32_t, long long>>& deltas) {
+    size_t applied = 0;
+    for (const pair<uint32_t, long long>& delta : deltas) {
+        uint32_t id = delta.first;
+        if (id != 0 && id <= words.size() && !words.erased(id)) {
+            words.setFreq(id, addClamped(words.freq(id), delta.second));
+            applied++;
+        }
     }
+    if (applied > 0) {
+        repairFrequencies();
+    }
+    return applied;
+}
+
+/* Remove a word from the trie, unlinking the nodes left leading to no
+    word and recomputing maxFreq on the way up.
+    arguments: the word
+    return: true if the word was in the trie
+ */
+bool DictionaryTrie::erase(string_view word) {
+    uint32_t id = findPath(word);
+    if (id == 0) {
+        return false;
+    }
+    unsigned int oldFreq = words.freq(id);
+    nodes[insertPath.back()].word.store(0, memory_order_release);
+    words.erase(id);
+    patternIndexFresh = false;
+    if (topK.k > 0) {
+        // while the path is still linked
+        reorderPrecomputed(word, id, true);
+    }
+    pruneDeadNodes();
+    lowerMaxFreq(oldFreq);
+    refreshRootTable(word);
     return true;
 }
 
+/* Remove many words at once, sharing the walk down to them and the
+    maxFreq repair on the way back up.
+    arguments: the words
+    return: the number of words removed
+ */
+size_t DictionaryTrie::eraseAll(const vector<string_view>& texts) {
+    // in the order of the trie, without duplicates, so that the words
+    // under every node are a range
+    vector<string_view> sorted;
+    for (string_view text : texts) {
+        if (text.length() > 0) {
+            sorted.push_back(text);
+        }
+    }
+    auto less = [](string_view w1, string_view w2) {
+        return lexicographical_compare(w1.begin(), w1.end(), w2.begin(),
+                                       w2.end());
+    };
+    if (!is_sorted(sorted.begin(), sorted.end(), less)) {
+        sort(sorted.begin(), sorted.end(), less);
+    }
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+    size_t erased = 0;
+    unsigned int lost = 0;
+    root.store(eraseSorted(root, sorted, 0, sorted.size(), 0, erased, lost),
+               memory_order_release);
+    if (erased > 0) {
+        // the sorted words sharing their first two letters are adjacent
+        for (size_t w = 0; w < sorted.size(); w++) {
+            if (w == 0 ||
+                sorted[w].substr(0, 2) != sorted[w - 1].substr(0, 2)) {
+                refreshRootTable(sorted[w]);
+            }
+        }
+        patternIndexFresh = false;
+        if (topK.k > 0) {
+            precomputeCompletions(topK.k, topK.maxDepth);
+        }
+    }
+    return erased;
+}
+
+/* return: freq + delta, kept between 0 and UINT_MAX */
+unsigned int DictionaryTrie::addClamped(unsigned int freq, long long delta) {
+    long long sum = (long long)freq + delta;
+    return (unsigned int)clamp(sum, 0LL, (long long)UINT_MAX);
+}
+
+/* helper method for addFrequencies. Recomputes maxFreq and the
+    precomputed lists, and leaves the pattern index out, once the
+    frequencies have changed.
+ */
+void DictionaryTrie::repairFrequencies() {
+    recomputeMaxFreq(root);
+    patternIndexFresh = false;
+    if (topK.k > 0) {
+        precomputeCompletions(topK.k, topK.maxDepth);
+    }
+}
+
+/* helper method for upsert and addFrequency. Changes the frequency of a
+    word found by findPath and repairs what depends on it.
+    arguments: the word, its id, its new frequency
+ */
+void DictionaryTrie::setFrequency(string_view word, uint32_t id,
+                                  unsigned int freq) {
+    unsigned int oldFreq = words.freq(id);
+    if (freq == oldFreq) {
+        return;
+    }
+    if (freq > oldFreq) {
+        // raise maxFreq first, so that it covers the word at all times
+        raiseMaxFreq(freq);
+        words.setFreq(id, freq);
+    } else {
+        words.setFreq(id, freq);
+        lowerMaxFreq(oldFreq);
+    }
+    patternIndexFresh = false;
+    if (topK.k > 0) {
+        reorderPrecomputed(word, id, freq < oldFreq);
+    }
+}
+
+/* helper method for setFrequency. Recomputes the maxFreq of the nodes in
+    insertPath, bottom up, after a word under them dropped from oldFreq.
+ */
+void DictionaryTrie::lowerMaxFreq(unsigned int oldFreq) {
+    while (!insertPath.empty()) {
+        Node& node = nodes[insertPath.back()];
+        unsigned int maxFreq = node.maxFreq.load(memory_order_relaxed);
+        if (maxFreq > oldFreq) {
+            // another word is the max here, and so above
+            break;
+        }
+        unsigned int fresh = nodeMaxFreq(node);
+        if (fresh == maxFreq) {
+            // another word of the same frequency is the max
+            break;
+        }
+        node.maxFreq.store(fresh, memory_order_relaxed);
+        insertPath.pop_back();
+    }
+}
+
+/* helper method for erase. Unlinks the nodes at the bottom of insertPath
+    that lead to no word any more. A node unlinked from the mid of the node
+    above may leave that one without words too; one unlinked from a
+    sibling link leaves the node above as it was.
+ */
+void DictionaryTrie::pruneDeadNodes() {
+    while (!insertPath.empty()) {
+        uint32_t ptr = insertPath.back();
+        const Node& node = nodes[ptr];
+        if (node.word.load(memory_order_relaxed) != 0 ||
+            node.mid.load(memory_order_relaxed) != 0) {
+            break;
+        }
+        insertPath.pop_back();
+        atomic<uint32_t>* link = &root;
+        if (!insertPath.empty()) {
+            Node& parent = nodes[insertPath.back()];
+            if (parent.left.load(memory_order_relaxed) == ptr) {
+                link = &parent.left;
+            } else if (parent.right.load(memory_order_relaxed) == ptr) {
+                link = &parent.right;
+            } else {
+                link = &parent.mid;
+            }
+        }
+        link->store(spliceOut(ptr), memory_order_release);
+        releaseNode(ptr);
+        if (insertPath.empty() || link != &nodes[insertPath.back()].mid) {
+            break;
+        }
+    }
+}
+
+/* helper method for eraseAll. Erases the words [lo, hi) of sorted from the
+    sibling chain rooted at ptr, visiting only the nodes on their way.
+    Those nodes are unlinked if they lead to no word any more, and get
+    their maxFreq recomputed otherwise, bottom up, unless it is above every
+    frequency erased under them.
+    arguments: the root of the chain, the sorted words, which share their
+    first depth letters and are longer than depth, the number of words
+    erased so far, the largest frequency erased so far
+    return: the root of what is left of the chain
+ */
+uint32_t DictionaryTrie::eraseSorted(uint32_t ptr,
+                                     const vector<string_view>& sorted,
+                                     size_t lo, size_t hi, size_t depth,
+                                     size_t& erased, unsigned int& lost) {
+    if (ptr == 0 || lo == hi) {
+        return ptr;
+    }
+    Node& node = nodes[ptr];
+    // the words before, at and after the letter of this node
+    auto first = partition_point(
+        sorted.begin() + lo, sorted.begin() + hi,
+        [&node, depth](string_view w) { return w[depth] < node.letter; });
+    auto last = partition_point(
+        first, sorted.begin() + hi,
+        [&node, depth](string_view w) { return w[depth] == node.letter; });
+    size_t at = first - sorted.begin();
+    size_t after = last - sorted.begin();
+
+    // the largest frequency erased under this node
+    unsigned int below = 0;
+    node.left.store(
+        eraseSorted(node.left, sorted, lo, at, depth, erased, below),
+        memory_order_relaxed);
+    node.right.store(
+        eraseSorted(node.right, sorted, after, hi, depth, erased, below),
+        memory_order_relaxed);
+    if (at < after && sorted[at].length() == depth + 1) {
+        // the word ending here sorts before the longer ones
+        uint32_t id = node.word.load(memory_order_relaxed);
+        if (id != 0) {
+            node.word.store(0, memory_order_relaxed);
+            words.erase(id);
+            erased++;
+            below = max(below, words.freq(id));
+        }
+        at++;
+    }
+    node.mid.store(
+        eraseSorted(node.mid, sorted, at, after, depth + 1, erased, below),
+        memory_order_relaxed);
+    lost = max(lost, below);
+
+    if (node.word.load(memory_order_relaxed) == 0 &&
+        node.mid.load(memory_order_relaxed) == 0) {
+        uint32_t replacement = spliceOut(ptr);
+        releaseNode(ptr);
+        return replacement;
+    }
+    if (below >= node.maxFreq.load(memory_order_relaxed)) {
+        node.maxFreq.store(nodeMaxFreq(node), memory_order_relaxed);
+    }
+    return ptr;
+}
+
+/* Take a node out of its sibling chain, keeping the chain in order. With
+    siblings on both sides, the first sibling after it takes its place.
+    return: the node to link in its place
+ */
+uint32_t DictionaryTrie::spliceOut(uint32_t ptr) {
+    const Node& node = nodes[ptr];
+    uint32_t left = node.left.load(memory_order_relaxed);
+    uint32_t right = node.right.load(memory_order_relaxed);
+    if (left == 0) {
+        return right;
+    }
+    if (right == 0) {
+        return left;
+    }
+
+    // the leftmost node on the right, and the nodes on the way to it
+    vector<uint32_t> between;
+    uint32_t next = right;
+    while (nodes[next].left.load(memory_order_relaxed) != 0) {
+        between.push_back(next);
+        next = nodes[next].left.load(memory_order_relaxed);
+    }
+    Node& successor = nodes[next];
+    if (!between.empty()) {
+        // lift it out, and fix the maxFreq of the nodes that lost it
+        nodes[between.back()].left.store(
+            successor.right.load(memory_order_relaxed), memory_order_relaxed);
+        successor.right.store(right, memory_order_relaxed);
+        for (size_t i = between.size(); i > 0; i--) {
+            Node& above = nodes[between[i - 1]];
+            above.maxFreq.store(nodeMaxFreq(above), memory_order_relaxed);
+        }
+    }
+    successor.left.store(left, memory_order_relaxed);
+    successor.maxFreq.store(nodeMaxFreq(successor), memory_order_relaxed);
+    return next;
+}
+
+/* Give a node that was unlinked back to the node arena */
+void DictionaryTrie::releaseNode(uint32_t ptr) {
+    nodes.release(ptr);
+    // a reused node starts a new prefix
+    topK.listOf.erase(ptr);
+}
+
+/* return: the maxFreq of the node, computed from its word and children */
+unsigned int DictionaryTrie::nodeMaxFreq(const Node& node) const {
+    uint32_t word = node.word.load(memory_order_relaxed);
+    unsigned int maxFreq = word != 0 ? words.freq(word) : 0;
+    for (uint32_t child : {node.left.load(memory_order_relaxed),
+                           node.mid.load(memory_order_relaxed),
+                           node.right.load(memory_order_relaxed)}) {
+        if (child != 0) {
+            maxFreq = max(maxFreq, nodes[child].maxFreq.load());
+        }
+    }
+    return maxFreq;
+}
+
+/* helper method for addFrequencies. Recomputes the maxFreq of every node
+    in the subtree, bottom up.
+    return: the maxFreq of the subtree
+ */
+unsigned int DictionaryTrie::recomputeMaxFreq(uint32_t ptr) {
+    if (ptr == 0) {
+        return 0;
+    }
+    Node& node = nodes[ptr];
+    recomputeMaxFreq(node.left);
+    recomputeMaxFreq(node.mid);
+    recomputeMaxFreq(node.right);
+    unsigned int maxFreq = nodeMaxFreq(node);
+    node.maxFreq.store(maxFreq, memory_order_relaxed);
+    return maxFreq;
+}
+
+/* the order of words used by the TST: letter by letter, comparing chars
+    the same way the descent loops do
+ */
+static bool lessByLetters(const pair<string_view, unsigned int>& e1,
+                          const pair<string_view, unsigned int>& e2) {
+    return lexicographical_compare(e1.first.begin(), e1.first.end(),
+                                   e2.first.begin(), e2.first.end());
+}
+
+/* Build a balanced trie from a whole set of words at once.
+    arguments: pairs of word and frequency, best sorted alphabetically,
+    the number of threads
+ */
+void DictionaryTrie::buildFromSorted(
+    const vector<pair<string_view, unsigned int>>& entries,
+    unsigned int numThreads) {
+    if (root != 0) {
+        // fall back to the incremental path on a populated trie
+        for (const pair<string_view, unsigned int>& e : entries) {
+            insert(e.first, e.second);
+        }
+        return;
+    }
+
+    patternIndexFresh = false;
+    if (numThreads <= 1) {
+        EntryList sorted(entries);
+        sortUnique(sorted);
+        size_t count = countNodes(sorted, 0, sorted.size(), 0);
+        if (count == 0) {
+            return;
+        }
+        uint32_t next = nodes.allocateRange(count, '\0');
+        uint32_t firstWord = addWords(sorted);
+        root.store(buildLevel(sorted, 0, sorted.size(), 0, firstWord, next),
+                   memory_order_release);
+        fillRootTable(root, -1);
+        if (topK.k > 0) {
+            precomputeCompletions(topK.k, topK.maxDepth);
+        }
+        return;
+    }
+
+    // split the words by first letter, keeping their order
+    vector<EntryList> buckets(256);
+    for (const pair<string_view, unsigned int>& e : entries) {
+        if (e.first.length() > 0) {
+            buckets[(unsigned char)e.first[0]].push_back(e);
+        }
+    }
+    // the first letters in the order the TST compares them
+    vector<EntryList*> groups;
+    for (int c = CHAR_MIN; c <= CHAR_MAX; c++) {
+        if (!buckets[(unsigned char)c].empty()) {
+            groups.push_back(&buckets[(unsigned char)c]);
+        }
+    }
+    // every thread starts on its largest groups and the small ones are
+    // left at the back of its share to be stolen
+    vector<size_t> order(groups.size());
+    for (size_t g = 0; g < groups.size(); g++) {
+        order[g] = g;
+    }
+    sort(order.begin(), order.end(), [&groups](size_t g1, size_t g2) {
+        return groups[g1]->size() > groups[g2]->size();
+    });
+
+    vector<size_t> counts(groups.size());
+    WorkPool::run(groups.size(), numThreads, [&](size_t i) {
+        EntryList& group = *groups[order[i]];
+        sortUnique(group);
+        counts[order[i]] = countNodes(group, 0, group.size(), 0);
+    });
+
+    // give every group its own slice of one allocated range
+    size_t total = 0;
+    for (size_t count : counts) {
+        total += count;
+    }
+    if (total == 0) {
+        return;
+    }
+    vector<uint32_t> starts(groups.size());
+    starts[0] = nodes.allocateRange(total, '\0');
+    for (size_t g = 1; g < groups.size(); g++) {
+        starts[g] = starts[g - 1] + (uint32_t)counts[g - 1];
+    }
+    // the word pool takes one word at a time, so the words are added
+    // before the tasks start
+    vector<uint32_t> firstWords(groups.size());
+    for (size_t g = 0; g < groups.size(); g++) {
+        firstWords[g] = addWords(*groups[g]);
+    }
+
+    vector<uint32_t> roots(groups.size());
+    WorkPool::run(groups.size(), numThreads, [&](size_t i) {
+        size_t g = order[i];
+        uint32_t next = starts[g];
+        roots[g] = buildLevel(*groups[g], 0, groups[g]->size(), 0,
+                              firstWords[g], next);
+    });
+    root.store(stitch(roots, 0, roots.size()), memory_order_release);
+    fillRootTable(root, -1);
+    if (topK.k > 0) {
+        precomputeCompletions(topK.k, topK.maxDepth);
+    }
+}
+
+/* Build a balanced trie from a whole set of words at once. */
+void DictionaryTrie::buildFromSorted(
+    const vector<pair<string, unsigned int>>& entries) {
+    vector<pair<string_view, unsigned int>> views;
+    views.reserve(entries.size());
+    for (const pair<string, unsigned int>& e : entries) {
+        views.push_back(pair<string_view, unsigned int>(e.first, e.second));
+    }
+    buildFromSorted(views);
+}
+
 /* This is the function to find whether the word is in the trie.
     arguments: the target word
     return true if the word is found, false otherwise
  */
-bool DictionaryTrie::find(string word) const {
+bool DictionaryTrie::find(string word) const { return wordId(word) != 0; }
+
+/* return: the id of the word, or 0 if it is not in the trie */
+uint32_t DictionaryTrie::wordId(string_view word) const {
     if (word.length() == 0) {
-        return false;
+        return 0;
     }
     if (root == 0) {
-        return false;
+        return 0;
     }
 
-    Node* ptr = root;
+    uint32_t ptr = root;
     char letter = word[0];
-    int i = 1;
+    size_t i = 1;
+    if (rootTable) {
+        // jump to the node of the first two letters
+        size_t depth;
+        ptr = shortcut(word, depth);
+        if (ptr == 0 || (depth == 0 && word.length() > 1)) {
+            return 0;
+        }
+        letter = word[depth];
+        i = depth + 1;
+    }
     while (true) {
-        if (letter < ptr->letter) {
+        const Node& node = nodes[ptr];
+        if (letter < node.letter) {
             // search the left subtree
-            if (ptr->left != nullptr) {
-                ptr = ptr->left;
+            if (node.left != 0) {
+                ptr = node.left;
             } else {
-                return false;
+                return 0;
             }
-        } else if (letter > ptr->letter) {
+        } else if (letter > node.letter) {
             // search the right subtree
-            if (ptr->right != nullptr) {
-                ptr = ptr->right;
+            if (node.right != 0) {
+                ptr = node.right;
             } else {
-                return false;
+                return 0;
             }
         } else {
             // search the middle subtree
             if (i == word.length()) {
-                return ptr->is_word;
+                return node.word;
             } else {
-                if (ptr->mid != nullptr) {
+                if (node.mid != 0) {
                     letter = word[i];
-                    ptr = ptr->mid;
+                    ptr = node.mid;
                     i = i + 1;
                 } else {
-                    return false;
+                    return 0;
                 }
             }
         }
     }
 }
 
+/* return: the text of the word with the given (non-zero) id */
+string_view DictionaryTrie::wordText(uint32_t id) const {
+    return words.text(id);
+}
+
+/* return: the frequency of the word with the given (non-zero) id */
+unsigned int DictionaryTrie::wordFrequency(uint32_t id) const {
+    return words.freq(id);
+}
+
+/* return: the number of words in the trie */
+size_t DictionaryTrie::wordCount() const {
+    return words.size() - words.erasedCount();
+}
+
 /* Use frequency to complete the predict completions.
     arguments: prefix, number of completions return.
     return: a list of completions, sorted by their frequency
  */
-vector<string> DictionaryTrie::predictCompletions(string prefix,
-                                                  unsigned int numCompletions) {
+vector<string> DictionaryTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
     vector<string> results;
-    if (root == 0) {
-        // empty tree, no completions
-        return results;
+    predictCompletions(prefix, numCompletions, results);
+    return results;
+}
+
+/* Use frequency to complete the predict completions, reusing the strings
+    of the output list.
+    arguments: prefix, number of completions, the list of completions,
+    sorted by their frequency
+ */
+void DictionaryTrie::predictCompletions(const string& prefix,
+                                        unsigned int numCompletions,
+                                        vector<string>& results) const {
+    uint32_t ptr = findPrefix(prefix);
+    if (ptr == 0 || numCompletions == 0) {
+        // no completion exists
+        results.clear();
+        return;
+    }
+    completeFrom(ptr, prefix, numCompletions, results);
+}
+
+/* Use frequency to complete the predict completions, as word ids.
+    arguments: prefix, number of completions, the list of word ids,
+    sorted by their frequency
+ */
+void DictionaryTrie::predictCompletionIds(const string& prefix,
+                                          unsigned int numCompletions,
+                                          vector<uint32_t>& ids) const {
+    uint32_t ptr = findPrefix(prefix);
+    if (ptr == 0 || numCompletions == 0) {
+        // no completion exists
+        ids.clear();
+        return;
     }
+    completeIds(ptr, prefix, numCompletions, ids);
+}
 
-    if (numCompletions == 0) {
-        return results;
+/* helper method for predictCompletions and predictCompletionIds.
+    return: the node of the last letter of the prefix, the root for the
+    empty prefix, or 0 if no word starts with the prefix
+ */
+uint32_t DictionaryTrie::findPrefix(const string& prefix) const {
+    uint32_t ptr = root;
+    if (ptr == 0) {
+        // empty tree, no completions
+        return 0;
     }
 
-    Node* ptr = root;
     // if prefix is not empty string, then search whether completion exists
     if (prefix.length() != 0) {
         char letter = prefix[0];
-        int i = 1;
+        size_t i = 1;
+        if (rootTable) {
+            // jump to the node of the first two letters
+            size_t depth;
+            ptr = shortcut(prefix, depth);
+            if (ptr == 0 || (depth == 0 && prefix.length() > 1)) {
+                return 0;
+            }
+            letter = prefix[depth];
+            i = depth + 1;
+        }
 
         // search whether completion exists in the trie
         //      if exists, ptr pointing to the last letter of prefix
-        //      if not exists, return an empty vector
+        //      if not exists, return 0
         while (true) {
-            if (letter < ptr->letter) {
+            const Node& node = nodes[ptr];
+            if (letter < node.letter) {
                 // into left subtree
-                if (ptr->left != nullptr) {
-                    ptr = ptr->left;
+                if (node.left != 0) {
+                    ptr = node.left;
                 } else {
                     // no completion exists
-                    return results;
+                    return 0;
                 }
-            } else if (letter > ptr->letter) {
+            } else if (letter > node.letter) {
                 // into right subtree
-                if (ptr->right != nullptr) {
-                    ptr = ptr->right;
+                if (node.right != 0) {
+                    ptr = node.right;
                 } else {
                     // no completion exists
-                    return results;
+                    return 0;
                 }
             } else {
                 // into middle subtree
                 if (i == prefix.length()) {
                     break;
                 } else {
-                    if (ptr->mid != nullptr) {
+                    if (node.mid != 0) {
                         letter = prefix[i];
                         i++;
-                        ptr = ptr->mid;
+                        ptr = node.mid;
                     } else {
                         // no completion exists
-                        return results;
+                        return 0;
                     }
                 }
             }
         }
     }
+    return ptr;
+}
 
-    // implement PQ to improve efficiency
-    priority_queue<pair<int, string>, vector<pair<int, string>>, CompFreq> q;
-    if (prefix.length() == 0) {
-        dfs(root, "", q, numCompletions);
-    } else {
-        if (ptr->is_word) {
-            q.push(pair<int, string>(ptr->freq, prefix));
-        }
-        dfs(ptr->mid, prefix, q, numCompletions);
+/* helper method for predictCompletions and CompletionSession. Collects the
+    completions of a prefix that is in the trie.
+    arguments: the node of the last letter of the prefix (the root for the
+    empty prefix), the prefix, number of completions, the list of
+    completions, sorted by their frequency
+ */
+void DictionaryTrie::completeFrom(uint32_t ptr, const string& prefix,
+                                  unsigned int numCompletions,
+                                  vector<string>& results) const {
+    // spell out the winners only
+    vector<uint32_t>& ids = searchScratch().ids;
+    completeIds(ptr, prefix, numCompletions, ids);
+    results.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        results[i].assign(words.text(ids[i]));
+    }
+}
+
+/* helper method for completeFrom and predictCompletionIds. Collects the
+    ids of the completions of a prefix that is in the trie.
+    arguments: the node of the last letter of the prefix (the root for the
+    empty prefix), the prefix, number of completions, the list of word
+    ids, sorted by their frequency
+ */
+void DictionaryTrie::completeIds(uint32_t ptr, const string& prefix,
+                                 unsigned int numCompletions,
+                                 vector<uint32_t>& ids) const {
+    ids.clear();
+    if (root == 0 || numCompletions == 0) {
+        return;
     }
 
-    for (int i = 0; i < numCompletions; i++) {
-        if (q.size() > 0) {
-            results.push_back(q.top().second);
-            q.pop();
+    // copy the precomputed list if there is one, or else search
+    if (numCompletions <= topK.k && prefix.length() <= topK.maxDepth) {
+        unordered_map<uint32_t, uint32_t>::const_iterator it =
+            topK.listOf.find(prefix.length() == 0 ? 0 : ptr);
+        if (it != topK.listOf.end()) {
+            const uint32_t* entries =
+                topK.entries.data() + (size_t)it->second * topK.k;
+            for (unsigned int i = 0; i < numCompletions && entries[i] != 0;
+                 i++) {
+                ids.push_back(entries[i]);
+            }
+            return;
         }
     }
-    reverse(results.begin(), results.end());
-    return results;
+    searchIds(ptr, prefix, numCompletions, ids);
 }
 
-/* function for wildcard prediction
-          arguments: pattern with (or without) underscore(s)
-                      number of completions desired
-          return: a list of completions.
-          hints: if the patter is empty, the returned list is empty
-                if the patter is without underscore, return that patter
-                  if it is a word in the trie
+/* helper method for completeIds. Collects the ids of the completions of a
+    prefix that is in the trie by searching below it.
+    arguments: the node of the last letter of the prefix (the root for the
+    empty prefix), the prefix, number of completions, the list of word
+    ids, sorted by their frequency
+ */
+void DictionaryTrie::searchIds(uint32_t ptr, const string& prefix,
+                               unsigned int numCompletions,
+                               vector<uint32_t>& ids) const {
+    ids.clear();
+    if (root == 0 || numCompletions == 0) {
+        return;
+    }
+
+    SearchScratch& scratch = searchScratch();
+    scratch.heap.clear();
+    if (topKSearch == BEST_FIRST) {
+        bestFirst(ptr, prefix, numCompletions, scratch);
+    } else if (prefix.length() == 0) {
+        scratch.path.clear();
+        dfs(root, numCompletions, scratch);
+    } else {
+        const Node& node = nodes[ptr];
+        scratch.path.assign(prefix);
+        uint32_t word = node.word;
+        if (word != 0) {
+            offerCandidate(word, numCompletions, scratch);
+        }
+        dfs(node.mid, numCompletions, scratch);
+    }
+
+    vector<Candidate>& heap = scratch.heap;
+    sort_heap(heap.begin(), heap.end(), CandidateOrder{words});
+    for (const Candidate& c : heap) {
+        ids.push_back(c.word);
+    }
+}
+
+/* return: the search buffers of the calling thread */
+DictionaryTrie::SearchScratch& DictionaryTrie::searchScratch() {
+    static thread_local SearchScratch scratch;
+    return scratch;
+}
+
+/* helper method for completeIds. Searches below the prefix best first.
+    Every frontier entry is a subtree keyed by its maxFreq, or a word keyed
+    by its frequency. Popping the largest key either expands a subtree
+    (its word and its children go into the frontier) or emits a word, and
+    a word only comes out once no subtree left could hold anything better.
+    arguments: the node of the last letter of the prefix (the root for the
+    empty prefix), the prefix, number of completions, the buffers that
+    receive the winners in scratch.heap
+ */
+void DictionaryTrie::bestFirst(uint32_t ptr, const string& prefix,
+                               unsigned int numCompletions,
+                               SearchScratch& scratch) const {
+    vector<Frontier>& frontier = scratch.frontier;
+    frontier.clear();
+    FrontierOrder order{words};
+    auto push = [&](const Frontier& entry) {
+        frontier.push_back(entry);
+        push_heap(frontier.begin(), frontier.end(), order);
+    };
+
+    if (prefix.length() == 0) {
+        push(Frontier{nodes[ptr].maxFreq, ptr, 0});
+    } else {
+        const Node& node = nodes[ptr];
+        uint32_t word = node.word;
+        if (word != 0) {
+            push(Frontier{words.freq(word), ptr, word});
+        }
+        uint32_t mid = node.mid;
+        if (mid != 0) {
+            push(Frontier{nodes[mid].maxFreq, mid, 0});
+        }
+    }
+
+    // the winners come out best first, so they go to the heap in order
+    while (!frontier.empty() && scratch.heap.size() < numCompletions) {
+        pop_heap(frontier.begin(), frontier.end(), order);
+        Frontier top = frontier.back();
+        frontier.pop_back();
+        if (top.word != 0) {
+            scratch.heap.push_back(Candidate{top.key, top.word});
+            continue;
+        }
+
+        const Node& node = nodes[top.node];
+        uint32_t children[3] = {node.left, node.mid, node.right};
+        for (uint32_t p : children) {
+            if (p != 0) {
+                push(Frontier{nodes[p].maxFreq, p, 0});
+            }
+        }
+        uint32_t word = node.word;
+        if (word != 0) {
+            push(Frontier{words.freq(word), top.node, word});
+        }
+    }
+    // sort_heap in completeIds expects a heap, and a list sorted best
+    // first is one under the reversed order
+    reverse(scratch.heap.begin(), scratch.heap.end());
+}
+
+/* helper method for CompletionSession.
+    return: the node with the given letter in the sibling chain rooted at
+    ptr, or 0 if there is none
+ */
+uint32_t DictionaryTrie::findLetter(uint32_t ptr, char letter) const {
+    while (ptr != 0) {
+        const Node& node = nodes[ptr];
+        if (letter < node.letter) {
+            ptr = node.left;
+        } else if (letter > node.letter) {
+            ptr = node.right;
+        } else {
+            return ptr;
+        }
+    }
+    return 0;
+}
+
+/* Answer a batch of queries with numThreads threads.
+    arguments: the queries, the lists of completions (resized to one per
+    query), the number of threads
+ */
+void DictionaryTrie::predictCompletionsBatch(
+    const vector<BatchQuery>& queries, vector<vector<string>>& results,
+    unsigned int numThreads) const {
+    results.resize(queries.size());
+    WorkPool::run(queries.size(), numThreads, [&](size_t i) {
+        const BatchQuery& query = queries[i];
+        if (query.underscores) {
+            results[i] = predictUnderscores(query.text, query.numCompletions);
+        } else {
+            predictCompletions(query.text, query.numCompletions, results[i]);
+        }
+    });
+}
+
+/* function for wildcard prediction
+          arguments: pattern with (or without) underscore(s)
+                      number of completions desired
+          return: a list of completions.
+          hints: if the patter is empty, the returned list is empty
+                if the patter is without underscore, return that patter
+                  if it is a word in the trie
  */
 std::vector<string> DictionaryTrie::predictUnderscores(
-    string pattern, unsigned int numCompletions) {
+    const string& pattern, unsigned int numCompletions) const {
     vector<string> results;
     if (root == 0) {
         // empty tree, no completions
@@ -263,214 +1122,935 @@ std::vector<string> DictionaryTrie::predictUnderscores(
         return results;
     }
 
-    priority_queue<pair<int, string>, vector<pair<int, string>>, CompFreq> q;
-    underscoreHelper(pattern, root, q, numCompletions);
-    for (int i = 0; i < numCompletions; i++) {
-        if (q.size() > 0) {
-            results.push_back(q.top().second);
-            q.pop();
+    SearchScratch& scratch = searchScratch();
+    if (usePatternIndex(pattern)) {
+        patternIndex.match(pattern, numCompletions, scratch.ids);
+        for (uint32_t id : scratch.ids) {
+            results.push_back(string(words.text(id)));
         }
+        return results;
+    }
+    scratch.heap.clear();
+    scratch.path.clear();
+    matchPattern(root, pattern, numCompletions, scratch);
+    vector<Candidate>& heap = scratch.heap;
+    sort_heap(heap.begin(), heap.end(), CandidateOrder{words});
+    for (const Candidate& c : heap) {
+        results.push_back(string(words.text(c.word)));
     }
-    reverse(results.begin(), results.end());
     return results;
 }
 
-/* This is the destructor */
-DictionaryTrie::~DictionaryTrie() { deleteAll(root); }
+/* Complete a prefix that may have typos.
+    arguments: the prefix, the most edits allowed, number of completions
+    return: a list of completions, sorted by their number of edits, then by
+    their frequency
+ */
+vector<string> DictionaryTrie::predictFuzzy(
+    const string& prefix, unsigned int maxEdits,
+    unsigned int numCompletions) const {
+    vector<string> results;
+    if (root == 0 || numCompletions == 0) {
+        return results;
+    }
 
-/* Helper function for destructor. Recursively deletes all the nodes.
-    argument: a pointer pointing to the root of the subtree to be deleted.
+    SearchScratch& scratch = searchScratch();
+    scratch.fuzzy.clear();
+    scratch.path.clear();
+    // the row of the empty path: the first j letters of the prefix are j
+    // edits away from it
+    scratch.rows.resize(prefix.length() + 1);
+    for (size_t j = 0; j <= prefix.length(); j++) {
+        scratch.rows[j] = j;
+    }
+    fuzzyWalk(root, prefix, maxEdits, prefix.length(), numCompletions,
+              scratch);
+    vector<FuzzyCandidate>& heap = scratch.fuzzy;
+    sort_heap(heap.begin(), heap.end(), FuzzyOrder{words});
+    for (const FuzzyCandidate& c : heap) {
+        results.push_back(string(words.text(c.word)));
+    }
+    return results;
+}
+
+/* Find the best words matching a pattern of the language of
+    PatternAutomaton.
+    arguments: the pattern, number of completions
+    return: a list of the matching words, sorted by their frequency, empty
+    if the pattern is malformed
  */
-void DictionaryTrie::deleteAll(Node* ptr) {
-    if (ptr == 0) {
-        return;
+vector<string> DictionaryTrie::predictPattern(
+    const string& pattern, unsigned int numCompletions) const {
+    vector<string> results;
+    PatternAutomaton automaton;
+    if (root == 0 || numCompletions == 0 || !automaton.compile(pattern)) {
+        return results;
     }
-    deleteAll(ptr->left);
-    deleteAll(ptr->mid);
-    deleteAll(ptr->right);
-    delete ptr;
+
+    SearchScratch& scratch = searchScratch();
+    scratch.heap.clear();
+    scratch.path.clear();
+    matchAutomaton(root, automaton.start(), automaton, numCompletions,
+                   scratch);
+    vector<Candidate>& heap = scratch.heap;
+    sort_heap(heap.begin(), heap.end(), CandidateOrder{words});
+    for (const Candidate& c : heap) {
+        results.push_back(string(words.text(c.word)));
+    }
+    return results;
 }
 
-/* traverse through the subtree with given root, prune the branch if the
-    root of that branch fail to meet the requirement of being pushed to PQ
-        arguments: the root of the subtree,
-        a path showing how to reach the parent of the root, or empty if no
-      parent,
-        a piority queue to store all of the words,
-        the max size of PQ, which equals to numCompletions
-*/
-void DictionaryTrie::dfs(
-    Node* ptr, string path,
-    priority_queue<pair<int, string>, vector<pair<int, string>>, CompFreq>& q,
-    int k) {
-    if (ptr == nullptr) {
-        // if empty tree, return
+/* Precompute the best k completions of every prefix of at most maxDepth
+    letters, and of the empty prefix.
+    arguments: completions per prefix, the longest precomputed prefix
+ */
+void DictionaryTrie::precomputeCompletions(unsigned int k,
+                                           unsigned int maxDepth) {
+    topK.k = k;
+    topK.maxDepth = maxDepth;
+    topK.listOf.clear();
+    topK.entries.clear();
+    if (k == 0) {
+        topK.entries.shrink_to_fit();
         return;
     }
+    string path;
+    vector<uint32_t> best = precomputeLevel(root, path);
+    topK.listOf[0] = storeList(best);
+}
 
-    if (ptr->parent == nullptr || ptr->parent->mid == ptr) {
-        path = path + ptr->letter;
-    } else {
-        path[path.length() - 1] = ptr->letter;
+/* Choose how predictCompletions searches below the prefix */
+void DictionaryTrie::setTopKSearch(TopKSearch search) { topKSearch = search; }
+
+/* Index every word by its length and by the letter at each position */
+void DictionaryTrie::buildPatternIndex() {
+    patternIndex.build(words);
+    patternIndexFresh = true;
+}
+
+/* return: the number of bytes used by the pattern index */
+size_t DictionaryTrie::patternIndexMemoryUsage() const {
+    return patternIndex.memoryUsage();
+}
+
+/* Choose how predictUnderscores finds the words of a pattern */
+void DictionaryTrie::setPatternSearch(PatternSearch search) {
+    patternSearch = search;
+}
+
+/* Choose whether the lookups start from the root table */
+void DictionaryTrie::setRootTable(bool enabled) { rootTable = enabled; }
+
+/* return: the number of bytes used by the precomputed completions */
+size_t DictionaryTrie::precomputedMemoryUsage() const {
+    // the lists hold word ids, the texts are the ones of the word pool
+    size_t bytes = topK.entries.capacity() * sizeof(uint32_t);
+    // a hash node per list and a pointer per bucket
+    bytes += topK.listOf.size() * (sizeof(pair<uint32_t, uint32_t>) +
+                                   2 * sizeof(void*)) +
+             topK.listOf.bucket_count() * sizeof(void*);
+    return bytes;
+}
+
+/* return: the average number of nodes visited to find a word */
+double DictionaryTrie::averageDepth() const {
+    size_t total = 0;
+    size_t words = 0;
+    sumDepths(root, 1, total, words);
+    if (words == 0) {
+        return 0;
     }
-    if (q.size() >= k) {
-        // if PQ already full
-        if (ptr->maxFreq < q.top().first) {
-            // if maxFreq of the subtree < mimFreq in heap, return
-            return;
-        } else if (ptr->maxFreq == q.top().first && path > q.top().second) {
-            // if maxFreq of the subtree < mimFreq in heap, and with larger
-            // alphabet-order, return
-            return;
+    return (double)total / words;
+}
+
+/* return: the number of nodes in the trie */
+size_t DictionaryTrie::nodeCount() const { return nodes.size(); }
+
+/* return: the number of bytes reserved for the nodes and the words */
+size_t DictionaryTrie::memoryUsage() const {
+    size_t table = (firstNodes.size() + secondNodes.size()) * sizeof(uint32_t);
+    return nodes.bytesReserved() + table + words.memoryUsage();
+}
+
+/* This is the destructor. All the nodes live in the arena and all the
+    words in the pool, which release them chunk by chunk without walking
+    the tree.
+ */
+DictionaryTrie::~DictionaryTrie() {
+    nodes.clear();
+    words.clear();
+}
+
+/* helper method for buildFromSorted. Sorts the entries if needed, then
+   drops empty words and all but the first of equal words.
+ */
+void DictionaryTrie::sortUnique(EntryList& entries) {
+    if (!is_sorted(entries.begin(), entries.end(), lessByLetters)) {
+        // keep the first of equal words first
+        stable_sort(entries.begin(), entries.end(), lessByLetters);
+    }
+    // empty words sort first
+    size_t empty = 0;
+    while (empty < entries.size() && entries[empty].first.length() == 0) {
+        empty++;
+    }
+    entries.erase(entries.begin(), entries.begin() + empty);
+    entries.erase(unique(entries.begin(), entries.end(),
+                         [](const pair<string_view, unsigned int>& e1,
+                            const pair<string_view, unsigned int>& e2) {
+                             return e1.first == e2.first;
+                         }),
+                  entries.end());
+}
+
+/* helper method for buildFromSorted. Every distinct prefix longer than
+   depth gets one node, so a word needs a node for each of its letters
+   past the prefix it shares with the word before it.
+   return: the number of nodes buildLevel needs for the same arguments
+ */
+size_t DictionaryTrie::countNodes(const EntryList& entries, size_t lo,
+                                  size_t hi, size_t depth) {
+    size_t count = 0;
+    for (size_t i = lo; i < hi; i++) {
+        string_view word = entries[i].first;
+        size_t shared = depth;
+        if (i > lo) {
+            string_view before = entries[i - 1].first;
+            while (shared < before.length() && shared < word.length() &&
+                   before[shared] == word[shared]) {
+                shared++;
+            }
         }
+        count += word.length() - shared;
     }
+    return count;
+}
 
-    // check current node
-    if (ptr->is_word) {
-        if (q.size() < k) {
-            // if PQ not full, push
-            q.push(pair<int, string>(ptr->freq, path));
+/* helper method for buildFromSorted. Adds the words of the entries to the
+   word pool in order.
+   return: the id of the first word
+ */
+uint32_t DictionaryTrie::addWords(const EntryList& entries) {
+    uint32_t firstWord = (uint32_t)words.size() + 1;
+    for (const pair<string_view, unsigned int>& e : entries) {
+        words.add(e.first, e.second);
+    }
+    return firstWord;
+}
+
+/* helper method for buildFromSorted. Builds the sibling chain for the
+   letters at position depth of the entries in [lo, hi).
+   return: the root of the chain
+ */
+uint32_t DictionaryTrie::buildLevel(const EntryList& entries, size_t lo,
+                                    size_t hi, size_t depth,
+                                    uint32_t firstWord, uint32_t& next) {
+    if (lo == hi) {
+        return 0;
+    }
+    // split the entries into groups by their letter at depth
+    vector<size_t> groups;
+    for (size_t i = lo; i < hi; i++) {
+        if (i == lo || entries[i].first[depth] != entries[i - 1].first[depth]) {
+            groups.push_back(i);
+        }
+    }
+    groups.push_back(hi);
+    return buildSiblings(entries, groups, 0, groups.size() - 1, depth,
+                         firstWord, next);
+}
+
+/* helper method for buildLevel. Builds a balanced chain from the letter
+   groups [gLo, gHi) and computes maxFreq bottom-up.
+   return: the root of the chain
+ */
+uint32_t DictionaryTrie::buildSiblings(const EntryList& entries,
+                                       const vector<size_t>& groups,
+                                       size_t gLo, size_t gHi, size_t depth,
+                                       uint32_t firstWord, uint32_t& next) {
+    if (gLo == gHi) {
+        return 0;
+    }
+    // the median letter becomes the root of the chain
+    size_t g = gLo + (gHi - gLo) / 2;
+    size_t lo = groups[g];
+    size_t hi = groups[g + 1];
+    uint32_t ptr = next++;
+    nodes[ptr].letter = entries[lo].first[depth];
+
+    // the shortest entry of the group ends at this node
+    unsigned int maxFreq = 0;
+    if (entries[lo].first.length() == depth + 1) {
+        nodes[ptr].word.store(firstWord + (uint32_t)lo, memory_order_relaxed);
+        maxFreq = entries[lo].second;
+        lo++;
+    }
+    uint32_t mid = buildLevel(entries, lo, hi, depth + 1, firstWord, next);
+    uint32_t left =
+        buildSiblings(entries, groups, gLo, g, depth, firstWord, next);
+    uint32_t right =
+        buildSiblings(entries, groups, g + 1, gHi, depth, firstWord, next);
+
+    // the trie is published once it is complete, so these stores need no
+    // ordering
+    Node& node = nodes[ptr];
+    node.left.store(left, memory_order_relaxed);
+    node.mid.store(mid, memory_order_relaxed);
+    node.right.store(right, memory_order_relaxed);
+    for (uint32_t p : {left, mid, right}) {
+        if (p != 0 && nodes[p].maxFreq > maxFreq) {
+            maxFreq = nodes[p].maxFreq;
+        }
+    }
+    node.maxFreq.store(maxFreq, memory_order_relaxed);
+    return ptr;
+}
+
+/* helper method for buildFromSorted. Links the first letter subtrees
+   [lo, hi) into a balanced chain and computes its maxFreq.
+   return: the root of the chain
+ */
+uint32_t DictionaryTrie::stitch(const vector<uint32_t>& roots, size_t lo,
+                                size_t hi) {
+    if (lo == hi) {
+        return 0;
+    }
+    size_t m = lo + (hi - lo) / 2;
+    Node& node = nodes[roots[m]];
+    uint32_t left = stitch(roots, lo, m);
+    uint32_t right = stitch(roots, m + 1, hi);
+    node.left.store(left, memory_order_relaxed);
+    node.right.store(right, memory_order_relaxed);
+    for (uint32_t p : {left, right}) {
+        if (p != 0 && nodes[p].maxFreq > node.maxFreq) {
+            node.maxFreq.store(nodes[p].maxFreq, memory_order_relaxed);
+        }
+    }
+    return roots[m];
+}
+
+/* helper method for precomputeCompletions. Stores the list of every
+   precomputed prefix in the sibling chain rooted at ptr.
+   arguments: the root of the chain, the letters above it, the ids given
+   to the words so far
+   return: the best completions of the whole chain
+ */
+vector<uint32_t> DictionaryTrie::precomputeLevel(uint32_t ptr, string& path) {
+    vector<uint32_t> best;
+    if (ptr == 0) {
+        return best;
+    }
+    const Node& node = nodes[ptr];
+    if (path.length() >= topK.maxDepth) {
+        // below the precomputed prefixes, search the chain once
+        SearchScratch& scratch = searchScratch();
+        scratch.heap.clear();
+        scratch.path.assign(path);
+        dfs(ptr, topK.k, scratch);
+        vector<Candidate>& heap = scratch.heap;
+        sort_heap(heap.begin(), heap.end(), CandidateOrder{words});
+        for (const Candidate& c : heap) {
+            best.push_back(c.word);
+        }
+        return best;
+    }
+
+    // the completions of the prefix ending at this node
+    path.push_back(node.letter);
+    best = precomputeLevel(node.mid, path);
+    if (node.word != 0) {
+        best.push_back(node.word);
+    }
+    path.pop_back();
+    auto better = [this](uint32_t id1, uint32_t id2) {
+        return betterWord(id1, id2);
+    };
+    sort(best.begin(), best.end(), better);
+    if (best.size() > topK.k) {
+        best.resize(topK.k);
+    }
+    topK.listOf[ptr] = storeList(best);
+
+    // merge in the siblings
+    for (uint32_t p : {node.left.load(), node.right.load()}) {
+        vector<uint32_t> sibling = precomputeLevel(p, path);
+        best.insert(best.end(), sibling.begin(), sibling.end());
+    }
+    sort(best.begin(), best.end(), better);
+    if (best.size() > topK.k) {
+        best.resize(topK.k);
+    }
+    return best;
+}
+
+/* return: true if word id1 comes before word id2 in the completions */
+bool DictionaryTrie::betterWord(uint32_t id1, uint32_t id2) const {
+    // compared like CandidateOrder does
+    unsigned int freq1 = words.freq(id1);
+    unsigned int freq2 = words.freq(id2);
+    if (freq1 != freq2) {
+        return freq1 > freq2;
+    }
+    return words.text(id1) < words.text(id2);
+}
+
+/* Append a list of word ids to the precomputed lists.
+   return: the list number
+ */
+uint32_t DictionaryTrie::storeList(vector<uint32_t>& best) {
+    uint32_t list = topK.entries.size() / topK.k;
+    topK.entries.insert(topK.entries.end(), best.begin(), best.end());
+    topK.entries.resize((list + 1) * topK.k, 0);
+    return list;
+}
+
+/* Offer a new word to the list with the given number */
+void DictionaryTrie::offerWord(uint32_t list, uint32_t id) {
+    uint32_t* entries = topK.entries.data() + (size_t)list * topK.k;
+    unsigned int i = 0;
+    while (i < topK.k && entries[i] != 0 && !betterWord(id, entries[i])) {
+        i++;
+    }
+    if (i == topK.k) {
+        return;
+    }
+    for (unsigned int j = topK.k - 1; j > i; j--) {
+        entries[j] = entries[j - 1];
+    }
+    entries[i] = id;
+}
+
+/* Add a newly inserted word to the precomputed lists: every prefix list
+   on the way down is offered the word, and a prefix node without a list
+   was just created, so the word is its only completion.
+ */
+void DictionaryTrie::updatePrecomputed(string_view word, uint32_t id) {
+    offerWord(topK.listOf[0], id);
+
+    uint32_t ptr = root;
+    size_t i = 0;
+    size_t depth = min(word.length(), (size_t)topK.maxDepth);
+    while (i < depth) {
+        const Node& node = nodes[ptr];
+        if (word[i] < node.letter) {
+            ptr = node.left;
+        } else if (word[i] > node.letter) {
+            ptr = node.right;
         } else {
-            // if PQ full, compare with the min element
-            if (ptr->freq > q.top().first) {
-                q.pop();
-                q.push(pair<int, string>(ptr->freq, path));
-            } else if (ptr->freq == q.top().first && path < q.top().second) {
-                q.pop();
-                q.push(pair<int, string>(ptr->freq, path));
+            unordered_map<uint32_t, uint32_t>::iterator it =
+                topK.listOf.find(ptr);
+            if (it != topK.listOf.end()) {
+                offerWord(it->second, id);
+            } else {
+                vector<uint32_t> only(1, id);
+                topK.listOf[ptr] = storeList(only);
             }
+            ptr = node.mid;
+            i++;
         }
     }
+}
+
+/* Move a word whose frequency changed within the precomputed lists of its
+   prefixes: it leaves every list it is in and is offered again. Once it
+   has dropped out of a full list, the next best word may be one the list
+   never kept, so that list is searched again.
+   arguments: the word, its id, true if its frequency dropped
+ */
+void DictionaryTrie::reorderPrecomputed(string_view word, uint32_t id,
+                                        bool dropped) {
+    string prefix;
+    uint32_t ptr = root;
+    size_t i = 0;
+    size_t depth = min(word.length(), (size_t)topK.maxDepth);
+    vector<uint32_t> best;
+    while (true) {
+        // the list of the prefix ending at ptr, or of the empty prefix
+        unordered_map<uint32_t, uint32_t>::iterator it =
+            topK.listOf.find(i == 0 ? 0 : ptr);
+        if (it != topK.listOf.end()) {
+            uint32_t list = it->second;
+            uint32_t* entries = topK.entries.data() + (size_t)list * topK.k;
+            uint32_t* last = entries + topK.k;
+            uint32_t* found = std::find(entries, last, id);
+            bool full = last[-1] != 0;
+            if (found != last) {
+                copy(found + 1, last, found);
+                last[-1] = 0;
+            }
+            if (dropped && full && found != last) {
+                searchIds(i == 0 ? root.load() : ptr, prefix, topK.k, best);
+                copy(best.begin(), best.end(), entries);
+            } else if (!words.erased(id)) {
+                offerWord(list, id);
+            }
+        }
 
-    // sort the maxFreq(s) of children
-    vector<Node*> vtr;
-    for (Node* p : {ptr->left, ptr->mid, ptr->right}) {
-        if (p != nullptr) {
-            vtr.push_back(p);
+        // go down to the node of the next letter
+        if (i == depth) {
+            break;
+        }
+        if (i > 0) {
+            ptr = nodes[ptr].mid;
         }
+        while (word[i] != nodes[ptr].letter) {
+            const Node& node = nodes[ptr];
+            ptr = word[i] < node.letter ? node.left : node.right;
+        }
+        prefix.push_back(word[i]);
+        i++;
     }
-    sort(vtr.begin(), vtr.end(), CompNodeByMaxFrequent());
+}
 
-    // recursive to children by decreasing maxFreq
-    for (Node* p : vtr) {
-        dfs(p, path, q, k);
+/* helper method for averageDepth. Adds up the search depth of every word
+   in the subtree and counts the words.
+ */
+void DictionaryTrie::sumDepths(uint32_t ptr, size_t depth, size_t& total,
+                               size_t& words) const {
+    if (ptr == 0) {
+        return;
     }
+    const Node& node = nodes[ptr];
+    if (node.word != 0) {
+        total += depth;
+        words++;
+    }
+    sumDepths(node.left, depth + 1, total, words);
+    sumDepths(node.mid, depth + 1, total, words);
+    sumDepths(node.right, depth + 1, total, words);
 }
 
-/* helper method for predictUnderscore, so that we could fill in the
-   underscore and recursive down. arguments: subpattern (ignore the part
-   before the undersocre we just filled in)， a pointer pointing to node the
-   lettter of which is used to fill in the underscore a priority_queue used
-   to store the completions k (numOfCompletions) determines the max-size of
-   PQ we want, in order to improve efficiency
+/* traverse through the subtree with given root, prune the branch if the
+  root of that branch fail to meet the requirement of being pushed to the
+  heap
+    arguments: the root of the subtree, the max size of the heap, which
+  equals to numCompletions, the buffers of the search: scratch.path holds
+  the prefix shared by every word in the subtree (the letters above the
+  root, without the root's own letter) and the best words found so far are
+  in scratch.heap
  */
-void DictionaryTrie::underscoreHelper(
-    string pattern, Node* ptr,
-    priority_queue<pair<int, string>, vector<pair<int, string>>, CompFreq>& q,
-    int k) {
+void DictionaryTrie::dfs(uint32_t ptr, unsigned int k,
+                         SearchScratch& scratch) const {
     if (ptr == 0) {
+        // if empty tree, return
         return;
     }
-    if (pattern.length() == 0) {
+
+    const Node& node = nodes[ptr];
+    if (pruned(node.maxFreq, k, scratch)) {
         return;
     }
 
-    char letter = pattern[0];
-    int i = 1;
-    while (true) {
+    // check current node
+    scratch.path.push_back(node.letter);
+    uint32_t word = node.word;
+    if (word != 0) {
+        offerCandidate(word, k, scratch);
+    }
+
+    // the children by decreasing maxFreq, each read once since an insert
+    // may raise it meanwhile
+    uint32_t children[3] = {node.left, node.mid, node.right};
+    unsigned int keys[3];
+    bool present[3];
+    for (int c = 0; c < 3; c++) {
+        present[c] = children[c] != 0;
+        keys[c] = present[c] ? nodes[children[c]].maxFreq.load() : 0;
+    }
+    int order[3];
+    int count = orderByKey(keys, present, order);
+    for (int i = 0; i < count; i++) {
+        if (order[i] == 1) {
+            dfs(children[1], k, scratch);
+        } else {
+            // the siblings share the letters above this node
+            scratch.path.pop_back();
+            dfs(children[order[i]], k, scratch);
+            scratch.path.push_back(node.letter);
+        }
+    }
+    scratch.path.pop_back();
+}
+
+/* helper method for dfs. Offers the word with the given id to the heap of
+    the best k words.
+ */
+void DictionaryTrie::offerCandidate(uint32_t word, unsigned int k,
+                                    SearchScratch& scratch) const {
+    vector<Candidate>& heap = scratch.heap;
+    CandidateOrder order{words};
+    Candidate candidate{words.freq(word), word};
+    if (heap.size() >= k) {
+        if (!order(candidate, heap.front())) {
+            // not better than the worst word in the heap
+            return;
+        }
+        pop_heap(heap.begin(), heap.end(), order);
+        heap.pop_back();
+    }
+    heap.push_back(candidate);
+    push_heap(heap.begin(), heap.end(), order);
+}
+
+/* helper method for dfs, matchPattern and matchAutomaton.
+    return: true if the heap of the best k words is full and no word of a
+    subtree with the given maxFreq, below the letters in scratch.path,
+    could enter it
+ */
+bool DictionaryTrie::pruned(unsigned int maxFreq, unsigned int k,
+                            const SearchScratch& scratch) const {
+    if (scratch.heap.size() < k) {
+        return false;
+    }
+    const Candidate& worst = scratch.heap.front();
+    if (maxFreq < worst.freq) {
+        // if maxFreq of the subtree < mimFreq in heap
+        return true;
+    }
+    // if maxFreq of the subtree == mimFreq in heap, and every word of the
+    // subtree is later in alphabet-order
+    return maxFreq == worst.freq &&
+           string_view(scratch.path) > words.text(worst.word);
+}
+
+/* helper method for dfs, matchPattern and matchAutomaton. Orders the present
+    ones of three branches by decreasing key, keeping their order on equal
+    keys.
+    return: the number of present branches
+ */
+int DictionaryTrie::orderByKey(const unsigned int keys[3],
+                               const bool present[3], int order[3]) {
+    int count = 0;
+    for (int c = 0; c < 3; c++) {
+        if (!present[c]) {
+            continue;
+        }
+        int i = count++;
+        while (i > 0 && keys[order[i - 1]] < keys[c]) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = c;
+    }
+    return count;
+}
+
+/* helper method for predictUnderscores.
+   return: true if the pattern is better matched with the pattern index than
+   by the trie walk
+ */
+bool DictionaryTrie::usePatternIndex(const string& pattern) const {
+    if (patternSearch == TRIE_WALK || !patternIndexFresh) {
+        return false;
+    }
+    if (patternSearch == POSTINGS) {
+        return true;
+    }
+    // the posting lists of a few common letters are long, so the trie
+    // walk is only faster when a long run of fixed letters at the front
+    // (or the whole pattern, without underscores) narrows it to a small
+    // subtree right away
+    size_t leading = pattern.find('_');
+    return leading != string::npos && 2 * leading < pattern.length();
+}
+
+/* helper method for predictUnderscores. Matches the pattern letter after
+    the ones in scratch.path against the sibling chain rooted at ptr.
+    A letter walks the chain like find does, and an underscore takes every
+    letter of the chain: the node and its left and right siblings, by
+    decreasing maxFreq so that the heap fills up with good words early.
+    arguments: the root of the chain, the pattern, the max size of the
+    heap, the buffers of the search
+ */
+void DictionaryTrie::matchPattern(uint32_t ptr, const string& pattern,
+                                  unsigned int k,
+                                  SearchScratch& scratch) const {
+    char letter = pattern[scratch.path.length()];
+    while (ptr != 0) {
+        const Node& node = nodes[ptr];
+        if (pruned(node.maxFreq, k, scratch)) {
+            return;
+        }
         if (letter == '_') {
-            // if 'underscore', replace it with possible letter and do
-            // recursion
-            string nextPattern = ptr->letter + pattern.substr(i);
-            underscoreHelper(nextPattern, ptr, q, k);
-            underscoreHelper(pattern.substr(i - 1), ptr->left, q, k);
-            underscoreHelper(pattern.substr(i - 1), ptr->right, q, k);
+            break;
+        } else if (letter < node.letter) {
+            ptr = node.left;
+        } else if (letter > node.letter) {
+            ptr = node.right;
+        } else {
+            matchNode(ptr, pattern, k, scratch);
             return;
         }
-        if (letter < ptr->letter) {
-            // into left subtree
-            if (ptr->left != nullptr) {
-                ptr = ptr->left;
-            } else {
-                return;
+    }
+    if (ptr == 0) {
+        return;
+    }
+
+    // the best word this node can lead to: its own word at the end of
+    // the pattern, otherwise one below it
+    const Node& node = nodes[ptr];
+    bool last = scratch.path.length() + 1 == pattern.length();
+    uint32_t word = node.word;
+    uint32_t mid = node.mid;
+    uint32_t siblings[3] = {node.left, ptr, node.right};
+    unsigned int keys[3];
+    bool present[3];
+    for (int c = 0; c < 3; c += 2) {
+        present[c] = siblings[c] != 0;
+        keys[c] = present[c] ? nodes[siblings[c]].maxFreq.load() : 0;
+    }
+    if (last) {
+        present[1] = word != 0;
+        keys[1] = present[1] ? words.freq(word) : 0;
+    } else {
+        present[1] = mid != 0;
+        keys[1] = present[1] ? nodes[mid].maxFreq.load() : 0;
+    }
+    int order[3];
+    int count = orderByKey(keys, present, order);
+    for (int i = 0; i < count; i++) {
+        if (order[i] == 1) {
+            matchNode(ptr, pattern, k, scratch);
+        } else {
+            matchPattern(siblings[order[i]], pattern, k, scratch);
+        }
+    }
+}
+
+/* helper method for matchPattern. Matches the rest of the pattern below
+    the node ptr, whose letter matched.
+ */
+void DictionaryTrie::matchNode(uint32_t ptr, const string& pattern,
+                               unsigned int k, SearchScratch& scratch) const {
+    const Node& node = nodes[ptr];
+    scratch.path.push_back(node.letter);
+    if (scratch.path.length() == pattern.length()) {
+        // the word has to end exactly here
+        uint32_t word = node.word;
+        if (word != 0) {
+            offerCandidate(word, k, scratch);
+        }
+    } else {
+        matchPattern(node.mid, pattern, k, scratch);
+    }
+    scratch.path.pop_back();
+}
+
+/* helper method for predictFuzzy. Walks the subtree rooted at ptr like
+    dfs, one row of edit distances per letter. The smallest entry of a row
+    never drops in the rows below it, so it bounds the edits of every word
+    in the subtree from below.
+    arguments: the root of the subtree, the prefix, the most edits allowed,
+    the fewest edits between the prefix and a prefix of scratch.path, the
+    max size of the heap, the buffers of the search
+ */
+void DictionaryTrie::fuzzyWalk(uint32_t ptr, const string& prefix,
+                               unsigned int maxEdits, unsigned int bestEdits,
+                               unsigned int k, SearchScratch& scratch) const {
+    const Node& node = nodes[ptr];
+    size_t width = prefix.length() + 1;
+    const unsigned int* above =
+        scratch.rows.data() + scratch.path.length() * width;
+    unsigned int fewest = min(bestEdits, *min_element(above, above + width));
+    if (fewest > maxEdits || fuzzyPruned(fewest, node.maxFreq, k, scratch)) {
+        return;
+    }
+
+    // check current node
+    unsigned int edits =
+        min(bestEdits, editRow(prefix, node.letter, scratch));
+    scratch.path.push_back(node.letter);
+    uint32_t word = node.word;
+    if (word != 0 && edits <= maxEdits) {
+        vector<FuzzyCandidate>& heap = scratch.fuzzy;
+        FuzzyOrder order{words};
+        FuzzyCandidate candidate{edits, words.freq(word), word};
+        if (heap.size() < k || order(candidate, heap.front())) {
+            if (heap.size() >= k) {
+                pop_heap(heap.begin(), heap.end(), order);
+                heap.pop_back();
             }
-        } else if (letter > ptr->letter) {
-            // into right subtree
-            if (ptr->right != nullptr) {
-                ptr = ptr->right;
-            } else {
-                return;
+            heap.push_back(candidate);
+            push_heap(heap.begin(), heap.end(), order);
+        }
+    }
+
+    // the children by decreasing maxFreq. A sibling overwrites the row of
+    // this node, which is computed again before the middle child needs it
+    uint32_t children[3] = {node.left, node.mid, node.right};
+    unsigned int keys[3];
+    bool present[3];
+    for (int c = 0; c < 3; c++) {
+        present[c] = children[c] != 0;
+        keys[c] = present[c] ? nodes[children[c]].maxFreq.load() : 0;
+    }
+    int order[3];
+    int count = orderByKey(keys, present, order);
+    bool rowLost = false;
+    for (int i = 0; i < count; i++) {
+        scratch.path.pop_back();
+        if (order[i] == 1) {
+            if (rowLost) {
+                editRow(prefix, node.letter, scratch);
             }
+            scratch.path.push_back(node.letter);
+            fuzzyWalk(children[1], prefix, maxEdits, edits, k, scratch);
         } else {
-            // into middle subtree
-            if (i == pattern.length()) {
-                if (ptr->is_word) {
-                    if (q.size() < k) {
-                        q.push(pair<int, string>(ptr->freq, ptr->getWord()));
-                    } else {
-                        if (ptr->freq > q.top().first) {
-                            q.pop();
-                            q.push(
-                                pair<int, string>(ptr->freq, ptr->getWord()));
-                        } else if (ptr->freq == q.top().first &&
-                                   ptr->getWord() < q.top().second) {
-                            q.pop();
-                            q.push(
-                                pair<int, string>(ptr->freq, ptr->getWord()));
-                        }
-                    }
-                }
-                return;
-            } else {
-                if (ptr->mid != nullptr) {
-                    letter = pattern[i];
-                    ptr = ptr->mid;
-                    i = i + 1;
-                } else {
-                    return;
-                }
-            }
+            // the siblings share the letters above this node
+            fuzzyWalk(children[order[i]], prefix, maxEdits, bestEdits, k,
+                      scratch);
+            scratch.path.push_back(node.letter);
+            rowLost = true;
         }
     }
+    scratch.path.pop_back();
 }
 
-/* the comparator used in sorting nodes based on their frequecy.
-        arguments: two nodes to be compared
+/* helper method for fuzzyWalk. Computes the row of edit distances of a
+    letter after the ones in scratch.path: entry j is the number of edits
+    between the first j letters of the prefix and scratch.path followed by
+    the letter.
+    return: the last entry of the row
  */
-bool DictionaryTrie::CompFreq::operator()(const pair<int, string>& p1,
-                                          const pair<int, string>& p2) {
-    if (p1.first == p2.first) {
-        return p1.second < p2.second;
-    } else {
-        return p1.first > p2.first;
+unsigned int DictionaryTrie::editRow(const string& prefix, char letter,
+                                     SearchScratch& scratch) {
+    size_t width = prefix.length() + 1;
+    size_t depth = scratch.path.length();
+    scratch.rows.resize((depth + 2) * width);
+    // the rows of this letter, of the one above it and of the one above
+    // that, which a swap of two letters goes back to
+    unsigned int* row = scratch.rows.data() + (depth + 1) * width;
+    const unsigned int* above = row - width;
+    const unsigned int* twoAbove = depth > 0 ? above - width : nullptr;
+    row[0] = depth + 1;
+    for (size_t j = 1; j < width; j++) {
+        unsigned int replace = above[j - 1] + (prefix[j - 1] != letter);
+        row[j] = min({above[j] + 1, row[j - 1] + 1, replace});
+        if (j > 1 && depth > 0 && prefix[j - 1] == scratch.path[depth - 1] &&
+            prefix[j - 2] == letter) {
+            // swap the last two letters
+            row[j] = min(row[j], twoAbove[j - 2] + 1);
+        }
+    }
+    return row[width - 1];
+}
+
+/* helper method for fuzzyWalk.
+    return: true if the heap of the best k fuzzy completions is full and no
+    word of a subtree, at least the given edits away, with the given
+    maxFreq and below the letters in scratch.path, could enter it
+ */
+bool DictionaryTrie::fuzzyPruned(unsigned int edits, unsigned int maxFreq,
+                                 unsigned int k,
+                                 const SearchScratch& scratch) const {
+    if (scratch.fuzzy.size() < k) {
+        return false;
+    }
+    const FuzzyCandidate& worst = scratch.fuzzy.front();
+    if (edits != worst.edits) {
+        return edits > worst.edits;
+    }
+    if (maxFreq != worst.freq) {
+        return maxFreq < worst.freq;
     }
+    return string_view(scratch.path) > words.text(worst.word);
 }
-bool DictionaryTrie::CompNodeByMaxFrequent::operator()(const Node* ptr1,
-                                                       const Node* ptr2) {
-    return ptr1->maxFreq < ptr2->maxFreq;
+
+/* helper method for predictPattern. Runs the automaton over the subtree
+    rooted at ptr. A sibling is only visited if the automaton can read a
+    letter on its side of this node, and the middle child only if some
+    state is left after reading this node's letter.
+    arguments: the root of the subtree, the states of the automaton after
+    the letters above it, the automaton, the max size of the heap, the
+    buffers of the search
+ */
+void DictionaryTrie::matchAutomaton(uint32_t ptr, uint64_t states,
+                                    const PatternAutomaton& automaton,
+                                    unsigned int k,
+                                    SearchScratch& scratch) const {
+    const Node& node = nodes[ptr];
+    char lowest;
+    char highest;
+    if (!automaton.letterRange(states, lowest, highest) ||
+        pruned(node.maxFreq, k, scratch)) {
+        return;
+    }
+
+    // check current node
+    scratch.path.push_back(node.letter);
+    uint64_t next = automaton.step(states, node.letter);
+    uint32_t word = node.word;
+    if (word != 0 && automaton.accepts(next)) {
+        offerCandidate(word, k, scratch);
+    }
+
+    // the children that may hold a match, by decreasing maxFreq
+    uint32_t children[3] = {node.left, node.mid, node.right};
+    unsigned int keys[3];
+    bool present[3];
+    for (int c = 0; c < 3; c++) {
+        present[c] = children[c] != 0;
+        keys[c] = present[c] ? nodes[children[c]].maxFreq.load() : 0;
+    }
+    present[0] = present[0] && lowest < node.letter;
+    present[1] = present[1] && automaton.alive(next);
+    present[2] = present[2] && highest > node.letter;
+    int order[3];
+    int count = orderByKey(keys, present, order);
+    for (int i = 0; i < count; i++) {
+        if (order[i] == 1) {
+            matchAutomaton(children[1], next, automaton, k, scratch);
+        } else {
+            // the siblings share the letters above this node
+            scratch.path.pop_back();
+            matchAutomaton(children[order[i]], states, automaton, k,
+                           scratch);
+            scratch.path.push_back(node.letter);
+        }
+    }
+    scratch.path.pop_back();
+}
+
+bool DictionaryTrie::CandidateOrder::operator()(const Candidate& c1,
+                                                const Candidate& c2) const {
+    if (c1.freq != c2.freq) {
+        return c1.freq > c2.freq;
+    }
+    return words.text(c1.word) < words.text(c2.word);
+}
+
+bool DictionaryTrie::FuzzyOrder::operator()(const FuzzyCandidate& c1,
+                                            const FuzzyCandidate& c2) const {
+    if (c1.edits != c2.edits) {
+        return c1.edits < c2.edits;
+    }
+    return CandidateOrder{words}(Candidate{c1.freq, c1.word},
+                                 Candidate{c2.freq, c2.word});
+}
+
+bool DictionaryTrie::FrontierOrder::operator()(const Frontier& f1,
+                                               const Frontier& f2) const {
+    if (f1.key != f2.key) {
+        return f1.key < f2.key;
+    }
+    bool word1 = f1.word != 0;
+    bool word2 = f2.word != 0;
+    if (word1 != word2) {
+        // a subtree first, it may hold a word of the same key that comes
+        // earlier in the alphabet
+        return word1;
+    }
+    if (word1) {
+        return words.text(f1.word) > words.text(f2.word);
+    }
+    return f1.node > f2.node;
 }
 
 /*  Create a node. Argument: a letter to be inserted  */
 DictionaryTrie::Node::Node(char letter)
-    : letter(letter), is_word(false), freq(0), maxFreq(0) {
-    left = nullptr;
-    mid = nullptr;
-    right = nullptr;
-    parent = nullptr;
-}
-/* get the word from the chosen word node by iteration to the root  */
-string DictionaryTrie::Node::getWord() {
-    if (!is_word) {
-        return "";
-    }
-    string s = "";
-    Node* ptr = this;
-    s = ptr->letter + s;
-    while (ptr->parent != nullptr) {
-        if (ptr->parent->mid == ptr) {
-            s = ptr->parent->letter + s;
-        }
-        ptr = ptr->parent;
-    }
-    return s;
-}
\ No newline at end of file
+    : left(0),
+      mid(0),
+      right(0),
+      word(0),
+      maxFreq(0),
+      letter(letter) {}
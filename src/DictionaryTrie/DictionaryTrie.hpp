@@ -9,11 +9,18 @@
 #define DICTIONARY_TRIE_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <queue>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
+#include "NodeArena.hpp"
+#include "PatternAutomaton.hpp"
+#include "PatternIndex.hpp"
+#include "WordPool.hpp"
 
 using namespace std;
 
@@ -21,38 +28,205 @@ using namespace std;
  * The class for a dictionary ADT, implemented as either
  * a mulit-way trie or a ternary search tree.
  * Here we use a ternary search tree
+ *
+ * One thread may insert while any number of threads run find,
+ * predictCompletions and predictUnderscores, without locks. An insert
+ * builds the missing letters of its word off to the side, raises maxFreq
+ * on the way, and then makes the word visible with a single release
+ * store, of the link to the new nodes or of the word id. Readers therefore
+ * see every word either completely or not at all. Nodes never move, so a
+ * reader's position stays valid under an insert. upsert and addFrequency
+ * may run next to readers too: maxFreq is raised before a frequency grows
+ * and lowered after it shrinks, so it never hides a word. erase returns
+ * the nodes it unlinks to the arena, and later inserts reuse them, so it
+ * needs the trie to itself: a reader could otherwise still be on a node
+ * that is handed out again. Everything else (bulk builds, batches of
+ * frequency changes, precomputed lists, nodeCount) needs the trie to
+ * itself as well.
+ * The root table in front of the trie points at the nodes of the first
+ * two letters of every word, so that lookups skip the two sibling chains
+ * at the top. An insert sets its entries after linking the new nodes.
  */
 class DictionaryTrie {
+    friend class FrozenDictionaryTrie;
+    friend class MinimizedDictionaryTrie;
+    friend class CompletionSession;
+
   private:
-    /** inner class which defines a node of TST */
+    /** inner class which defines a node of TST.
+        Children are 32-bit indices into the node arena, 0 if absent.
+        The fields an insert may change after the node is linked are
+        atomic, for the readers running next to it.
+     */
     class Node {
       public:
-        Node* left;
-        Node* mid;
-        Node* right;
-        Node* parent;
+        atomic<uint32_t> left;
+        atomic<uint32_t> mid;
+        atomic<uint32_t> right;
+        // the id of the word ending at this node, 0 if none
+        atomic<uint32_t> word;
+        atomic<unsigned int> maxFreq;
         char letter;
-        bool is_word;
-        unsigned int freq;
-        unsigned int maxFreq;
 
         Node(char letter);
+    };
+
+    // index of the root of the trie, or 0 if empty trie
+    atomic<uint32_t> root;
 
-        string getWord();
+    // the root table, shortcuts past the top two sibling chains: the node
+    // of every first letter c is at firstNodes[c], and the node of every
+    // second letter d under it at secondNodes[c * 256 + d], 0 where no
+    // word starts so
+    vector<atomic<uint32_t>> firstNodes;
+    vector<atomic<uint32_t>> secondNodes;
+
+    // owns every node of the trie
+    NodeArena<Node> nodes;
+
+    // the id, text and frequency of every word
+    WordPool words;
+
+    // scratch stack of the nodes visited by insert
+    vector<uint32_t> insertPath;
+
+    /** the precomputed completions of the short prefixes */
+    struct TopKLists {
+        // completions kept per prefix, 0 if nothing is precomputed
+        unsigned int k;
+        // the longest precomputed prefix
+        unsigned int maxDepth;
+        // list number of each prefix node, node 0 for the empty prefix
+        unordered_map<uint32_t, uint32_t> listOf;
+        // k word ids per list, best first, padded with 0
+        vector<uint32_t> entries;
     };
+    TopKLists topK;
 
-    // ptr to the root of the trie, or 0 if empty trie
-    Node* root;
+    // the words by length, position and letter, for predictUnderscores
+    PatternIndex patternIndex;
+    // true while patternIndex holds every word of the trie
+    atomic<bool> patternIndexFresh;
 
   public:
+    /** the ways predictCompletions can search the subtree of a prefix */
+    enum TopKSearch {
+        // recursive depth first search, pruned by maxFreq
+        DEPTH_FIRST,
+        // the subtree with the largest maxFreq first, stopping after k
+        // words
+        BEST_FIRST
+    };
+
+    /** the ways predictUnderscores can find the words of a pattern */
+    enum PatternSearch {
+        // the pattern index when it is fresh, unless the letters before
+        // the first underscore are at least half of the pattern
+        PLANNED,
+        // descend the trie letter by letter, pruned by maxFreq
+        TRIE_WALK,
+        // intersect the posting lists of the pattern index, when it is
+        // fresh
+        POSTINGS
+    };
+
+    /** a query of predictCompletionsBatch */
+    struct BatchQuery {
+        // a prefix, or a pattern if underscores is true
+        string text;
+        unsigned int numCompletions;
+        bool underscores;
+    };
+
     /* It is the constructor*/
     DictionaryTrie();
 
-    /* This is the function to insert the word into the trie.
+    /* This is the function to insert the word into the trie. It may run
+        next to readers, but not next to another insert.
         arguments: word to insert, frequency of that word
         return: true if insertion is successful, false otherwise
      */
-    bool insert(string word, unsigned int freq);
+    bool insert(string_view word, unsigned int freq);
+
+    /* Build a balanced trie from a whole set of words at once. Each sibling
+        chain is built around its median letter, and maxFreq is filled in
+        by one bottom-up pass instead of being propagated on every insert.
+        If a word appears more than once, the first occurrence wins, just
+        like insert. If the trie is not empty, the words are inserted one
+        by one instead.
+        With several threads, the words are split by their first letter
+        and the subtree of each first letter is sorted and built by its own
+        task, then the subtrees are stitched under a balanced chain of
+        first letters. The trie holds the same words either way.
+        arguments: pairs of word and frequency, best sorted alphabetically
+        (unsorted input is sorted on a copy first), the number of threads
+     */
+    void buildFromSorted(
+        const vector<pair<string_view, unsigned int>>& entries,
+        unsigned int numThreads = 1);
+
+    /* Build a balanced trie from a whole set of words at once. */
+    void buildFromSorted(const vector<pair<string, unsigned int>>& entries);
+
+    /* Insert the word, or set its frequency if it is already in the trie.
+        A raise lifts maxFreq on the way down before the frequency
+        changes; a drop changes the frequency first and then recomputes
+        maxFreq from the children, going up only while it changes. Either
+        way maxFreq is never below a word under it, so this may run next
+        to readers, like insert.
+        arguments: the word, its frequency
+        return: true if the word was inserted, false if it was already
+        in the trie (or is empty)
+     */
+    bool upsert(string_view word, unsigned int freq);
+
+    /* Add delta, which may be negative, to the frequency of a word in the
+        trie, like upsert. The frequency stays between 0 and UINT_MAX.
+        arguments: the word, the change of its frequency
+        return: true if the word is in the trie
+     */
+    bool addFrequency(string_view word, long long delta);
+
+    /* Apply many frequency changes at once, like addFrequency. Only the
+        frequencies are changed as the deltas are read, then maxFreq is
+        recomputed by one bottom-up pass and the precomputed lists are
+        rebuilt, so a large batch costs about one pass over the trie. Words
+        not in the trie are skipped. The trie must not be read meanwhile.
+        arguments: pairs of word and change of its frequency
+        return: the number of deltas applied
+     */
+    size_t addFrequencies(const vector<pair<string_view, long long>>& deltas);
+
+    /* Apply many frequency changes at once, like the above, to the words
+        with the given ids (see wordId). This skips looking every word up,
+        which is most of the cost of a batch given by text, so a caller
+        that updates the same words again and again can keep their ids.
+        Ids that are not in the trie are skipped.
+        arguments: pairs of word id and change of its frequency
+        return: the number of deltas applied
+     */
+    size_t addFrequencies(const vector<pair<uint32_t, long long>>& deltas);
+
+    /* Remove a word from the trie. The nodes left leading to no word are
+        unlinked, a node with siblings on both sides giving its place to
+        the next sibling after it, and go back to the node arena for later
+        inserts to reuse. maxFreq is recomputed from the children on the
+        way up only while it changes, as when a frequency drops. The id of
+        the word is never given again.
+        arguments: the word
+        return: true if the word was in the trie
+     */
+    bool erase(string_view word);
+
+    /* Remove many words at once, like erase. The words are sorted and
+        erased in one walk down the trie, which visits every node on
+        their way once, however many of them share it, and unlinks the
+        dead nodes and recomputes maxFreq on the way back up. The
+        precomputed lists are rebuilt once, like addFrequencies.
+        arguments: the words
+        return: the number of words removed
+     */
+    size_t eraseAll(const vector<string_view>& texts);
 
     /* This is the function to find whether the word is in the trie.
         arguments: the target word
@@ -60,12 +234,64 @@ class DictionaryTrie {
      */
     bool find(string word) const;
 
+    /* return: the id of the word, or 0 if it is not in the trie. Every
+        word gets a dense id when it is inserted, from 1 to wordCount()
+        until a word is erased, which it keeps while the trie lives. The id
+        of an erased word is not given again.
+     */
+    uint32_t wordId(string_view word) const;
+
+    /* return: the text of the word with the given (non-zero) id, stored
+        once in the trie and valid while the trie lives
+     */
+    string_view wordText(uint32_t id) const;
+
+    /* return: the frequency of the word with the given (non-zero) id */
+    unsigned int wordFrequency(uint32_t id) const;
+
+    /* return: the number of words in the trie */
+    size_t wordCount() const;
+
     /* Use frequency to complete the predict completions.
         arguments: prefix, number of completions return.
         return: a list of completions, sorted by their frequency
      */
-    vector<string> predictCompletions(string prefix,
-                                      unsigned int numCompletions);
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* Use frequency to complete the predict completions, like the above,
+        into a list owned by the caller. The strings already in the list
+        are reused, so a caller that keeps one list across queries makes
+        the search allocate nothing once the list and the search buffers
+        of its thread have grown to fit.
+        arguments: prefix, number of completions, the list of completions,
+        sorted by their frequency
+     */
+    void predictCompletions(const string& prefix, unsigned int numCompletions,
+                            vector<string>& results) const;
+
+    /* Use frequency to complete the predict completions, like the above,
+        but give the ids of the completions instead of their text. Their
+        text and frequency are read with wordText and wordFrequency,
+        without building a string.
+        arguments: prefix, number of completions, the list of word ids,
+        sorted by their frequency
+     */
+    void predictCompletionIds(const string& prefix,
+                              unsigned int numCompletions,
+                              vector<uint32_t>& ids) const;
+
+    /* Answer a batch of queries, each one like predictCompletions or
+        predictUnderscores. The queries are spread over numThreads threads
+        that steal work from each other, so a few expensive queries do not
+        hold the others up. Queries never change the trie, but the trie
+        must not be changed while the batch runs.
+        arguments: the queries, the lists of completions (resized to one
+        per query), the number of threads
+     */
+    void predictCompletionsBatch(const vector<BatchQuery>& queries,
+                                 vector<vector<string>>& results,
+                                 unsigned int numThreads = 1) const;
 
     /* function for wildcard prediction
           arguments: pattern with (or without) underscore(s)
@@ -75,54 +301,491 @@ class DictionaryTrie {
                 if the patter is without underscore, return that patter
                   if it is a word in the trie
     */
-    vector<string> predictUnderscores(string pattern,
-                                      unsigned int numCompletions);
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const;
+
+    /* Complete a prefix that may have typos. A word is a completion if
+        some prefix of it is at most maxEdits edits away from the given
+        prefix, where an edit inserts, deletes or replaces a letter, or
+        swaps two letters next to each other. The trie is walked with one
+        row of edit distances per letter, and a subtree is skipped once
+        every row below it must exceed maxEdits, or once neither its
+        distance nor its maxFreq can beat the best words found so far.
+        arguments: the prefix, the most edits allowed, number of
+        completions
+        return: a list of completions, sorted by their number of edits,
+        then by their frequency
+     */
+    vector<string> predictFuzzy(const string& prefix, unsigned int maxEdits,
+                                unsigned int numCompletions) const;
+
+    /* Find the best words matching a pattern, where _ is any letter, * any
+        run of letters, [aeiou] or [a-z] any letter listed ([^...] any
+        other letter), a ? after an item makes it optional, and a
+        backslash makes the next character a plain letter (see
+        PatternAutomaton). The pattern is run in lockstep with the trie
+        walk, so a subtree is skipped as soon as no word in it can match,
+        or once its maxFreq cannot beat the best words found so far.
+        arguments: the pattern, number of completions
+        return: a list of the matching words, sorted by their frequency,
+        empty if the pattern is malformed
+     */
+    vector<string> predictPattern(const string& pattern,
+                                  unsigned int numCompletions) const;
+
+    /* Precompute the best k completions of every prefix of at most
+        maxDepth letters (and of the empty prefix), so that completing such
+        a prefix with at most k completions is a descent and a copy.
+        Later inserts keep the lists up to date. k = 0 drops the lists.
+        arguments: completions per prefix, the longest precomputed prefix
+     */
+    void precomputeCompletions(unsigned int k, unsigned int maxDepth);
+
+    /* return: the number of bytes used by the precomputed completions */
+    size_t precomputedMemoryUsage() const;
+
+    /* Choose how predictCompletions searches below the prefix. Both
+        searches give the same completions.
+     */
+    void setTopKSearch(TopKSearch search);
+
+    /* Index every word by its length and by the letter at each position,
+        so that predictUnderscores can intersect the words with each fixed
+        letter of a pattern instead of branching at each underscore.
+        The index is a snapshot: once a word is inserted,
+        predictUnderscores walks the trie again until the index is built
+        anew.
+     */
+    void buildPatternIndex();
+
+    /* return: the number of bytes used by the pattern index */
+    size_t patternIndexMemoryUsage() const;
+
+    /* Choose how predictUnderscores finds the words of a pattern. Every
+        search gives the same words.
+     */
+    void setPatternSearch(PatternSearch search);
+
+    /* Choose whether find, insert and the prefix lookups jump through the
+        root table straight to the node of the first two letters, or walk
+        the top sibling chains from the root. Both give the same answers,
+        and the table is kept up to date either way.
+     */
+    void setRootTable(bool enabled);
+
+    /* return: the average number of nodes visited to find a word */
+    double averageDepth() const;
+
+    /* return: the number of nodes in the trie */
+    size_t nodeCount() const;
+
+    /* return: the number of bytes reserved for the nodes, the root table
+        and the words
+     */
+    size_t memoryUsage() const;
 
     /* This is the destructor */
     ~DictionaryTrie();
 
   private:
-    /* the comparator used in sorting nodes based on their frequecy.
-        arguments: two nodes to be compared
+    // the search used by predictCompletions
+    TopKSearch topKSearch;
+    // the search used by predictUnderscores
+    PatternSearch patternSearch;
+    // true if the lookups start from the root table
+    bool rootTable;
+
+    /** the words of a bulk build */
+    typedef vector<pair<string_view, unsigned int>> EntryList;
+
+    /* helper method for buildFromSorted. Sorts the entries if needed, then
+       drops empty words and all but the first of equal words.
+     */
+    static void sortUnique(EntryList& entries);
+
+    /* helper method for buildFromSorted.
+       return: the number of nodes buildLevel needs for the same arguments
+     */
+    static size_t countNodes(const EntryList& entries, size_t lo, size_t hi,
+                             size_t depth);
+
+    /* helper method for buildFromSorted. Adds the words of the entries to
+       the word pool in order, so that entry i gets the id firstWord + i.
+       return: firstWord
      */
-    struct CompFreq {
-        bool operator()(const pair<int, string>& p1,
-                        const pair<int, string>& p2);
+    uint32_t addWords(const EntryList& entries);
+
+    /* helper method for buildFromSorted. Builds the sibling chain for the
+       letters at position depth of the entries in [lo, hi), which are sorted,
+       share their first depth letters and are all longer than depth.
+       The nodes are taken in order from the allocated range starting at
+       next, which is moved past them. Entry i has the word id
+       firstWord + i.
+       return: the root of the chain
+     */
+    uint32_t buildLevel(const EntryList& entries, size_t lo, size_t hi,
+                        size_t depth, uint32_t firstWord, uint32_t& next);
+
+    /* helper method for buildLevel. Builds a balanced chain from the letter
+       groups [gLo, gHi), where group g covers entries [groups[g],
+       groups[g + 1]).
+       return: the root of the chain
+     */
+    uint32_t buildSiblings(const EntryList& entries,
+                           const vector<size_t>& groups, size_t gLo,
+                           size_t gHi, size_t depth, uint32_t firstWord,
+                           uint32_t& next);
+
+    /* helper method for buildFromSorted. Links the first letter subtrees
+       [lo, hi) into a balanced chain and computes its maxFreq.
+       return: the root of the chain
+     */
+    uint32_t stitch(const vector<uint32_t>& roots, size_t lo, size_t hi);
+
+    /** a word found by a search, with its frequency at hand */
+    struct Candidate {
+        unsigned int freq;
+        uint32_t word;
+    };
+
+    /** the order of the completions: the higher frequency first, then
+        the word earlier in the alphabet. true if c1 comes before c2
+     */
+    struct CandidateOrder {
+        const WordPool& words;
+        bool operator()(const Candidate& c1, const Candidate& c2) const;
     };
 
-    struct CompNodeByMaxFrequent {
-        bool operator()(const Node* ptr1, const Node* ptr2);
+    /** a word found by predictFuzzy, with its distance from the prefix */
+    struct FuzzyCandidate {
+        unsigned int edits;
+        unsigned int freq;
+        uint32_t word;
     };
-    /* Helper function for destructor. Recursively deletes all the nodes.
-        argument: a pointer pointing to the root of the subtree to be deleted.
+
+    /** the order of the fuzzy completions: fewer edits first, then the
+        order of the completions. true if c1 comes before c2
      */
-    void deleteAll(Node* ptr);
+    struct FuzzyOrder {
+        const WordPool& words;
+        bool operator()(const FuzzyCandidate& c1,
+                        const FuzzyCandidate& c2) const;
+    };
+
+    /** an entry of the best-first frontier: a subtree, or a word */
+    struct Frontier {
+        // maxFreq of the subtree, or the frequency of the word
+        unsigned int key;
+        // the root of the subtree
+        uint32_t node;
+        // the id of the word, or 0 for a subtree
+        uint32_t word;
+    };
+
+    /** the order of the best-first frontier: larger keys first, a subtree
+        before a word of the same key, then words in alphabetical order
+     */
+    struct FrontierOrder {
+        const WordPool& words;
+        bool operator()(const Frontier& f1, const Frontier& f2) const;
+    };
+
+    /** the buffers of a completion search. Each thread keeps its own, so
+        a search in steady state allocates nothing. The words are named by
+        their ids, so no text is copied until the winners are known.
+     */
+    struct SearchScratch {
+        // the letters of the current node (dfs and matchAutomaton), or the
+        // letters matched so far (matchPattern)
+        string path;
+        // the best words so far, the worst at the front (dfs,
+        // matchPattern and matchAutomaton), or the winners (bestFirst)
+        vector<Candidate> heap;
+        // the frontier (bestFirst)
+        vector<Frontier> frontier;
+        // the winners, best first
+        vector<uint32_t> ids;
+        // the best fuzzy completions so far, the worst at the front
+        // (fuzzyWalk)
+        vector<FuzzyCandidate> fuzzy;
+        // the edit distances between the prefixes of the typed prefix and
+        // path, one row per letter of path and one for the empty path
+        // (fuzzyWalk)
+        vector<unsigned int> rows;
+    };
+
+    /* return: the search buffers of the calling thread */
+    static SearchScratch& searchScratch();
+
+    /* helper method for predictCompletions and predictCompletionIds.
+       return: the node of the last letter of the prefix, the root for the
+       empty prefix, or 0 if no word starts with the prefix
+     */
+    uint32_t findPrefix(const string& prefix) const;
+
+    /* helper method for predictCompletions and CompletionSession. Collects
+       the completions of a prefix that is in the trie.
+       arguments: the node of the last letter of the prefix (the root for
+       the empty prefix), the prefix, number of completions, the list of
+       completions, sorted by their frequency
+     */
+    void completeFrom(uint32_t ptr, const string& prefix,
+                      unsigned int numCompletions,
+                      vector<string>& results) const;
+
+    /* helper method for completeFrom and predictCompletionIds, with the
+       same arguments, that gives the ids of the completions
+     */
+    void completeIds(uint32_t ptr, const string& prefix,
+                     unsigned int numCompletions, vector<uint32_t>& ids) const;
+
+    /* helper method for completeIds, with the same arguments, that always
+       searches the trie, even if the prefix has a precomputed list
+     */
+    void searchIds(uint32_t ptr, const string& prefix,
+                   unsigned int numCompletions, vector<uint32_t>& ids) const;
+
+    /* helper method for completeIds. Searches the subtree rooted at ptr
+       best first: the frontier entry with the largest key is expanded
+       until k words have come out of it.
+       arguments: the root of the subtree, the letters above it, number of
+       completions, the buffers that receive the completions in
+       scratch.heap
+     */
+    void bestFirst(uint32_t ptr, const string& prefix,
+                   unsigned int numCompletions, SearchScratch& scratch) const;
+
+    /* helper method for CompletionSession.
+       return: the node with the given letter in the sibling chain rooted
+       at ptr, or 0 if there is none
+     */
+    uint32_t findLetter(uint32_t ptr, char letter) const;
+
+    /* helper method for insert. Raises the maxFreq of the nodes in
+       insertPath to freq where it is lower.
+     */
+    void raiseMaxFreq(unsigned int freq);
+
+    /* return: the node of letter word[depth], found in the root table,
+       where depth is 1 if the table has the first two letters of the
+       word and 0 if it only has the first; 0 if it has neither
+     */
+    uint32_t shortcut(string_view word, size_t& depth) const;
+
+    /* helper method for insert. Raises the maxFreq of the nodes above
+       start, which the root table skipped, where it is lower.
+       arguments: the word, the node insert started from, the frequency
+     */
+    void raiseAbove(string_view word, uint32_t start, unsigned int freq);
+
+    /* Set the root table entries of the first two letters of the word from
+       the trie, after they may have been unlinked.
+     */
+    void refreshRootTable(string_view word);
+
+    /* Record every node of the top two sibling chains in the root table.
+       arguments: the root of the chain, its first letter above it, or -1
+       for the top chain
+     */
+    void fillRootTable(uint32_t ptr, int first);
+
+    /* helper method for upsert and addFrequency. Finds a word, keeping
+       every node visited in insertPath.
+       return: the id of the word, or 0 if it is not in the trie
+     */
+    uint32_t findPath(string_view word);
+
+    /* helper method for upsert and addFrequency. Changes the frequency of
+       a word found by findPath and repairs maxFreq, the pattern index and
+       the precomputed lists.
+       arguments: the word, its id, its new frequency
+     */
+    void setFrequency(string_view word, uint32_t id, unsigned int freq);
+
+    /* helper method for setFrequency. Recomputes the maxFreq of the nodes
+       in insertPath, bottom up, after a word under them dropped from
+       oldFreq, stopping at the first node that keeps its maxFreq.
+     */
+    void lowerMaxFreq(unsigned int oldFreq);
+
+    /* return: the maxFreq of the node, computed from its word and its
+       children
+     */
+    unsigned int nodeMaxFreq(const Node& node) const;
+
+    /* helper method for addFrequencies. Recomputes the maxFreq of every
+       node in the subtree, bottom up.
+       return: the maxFreq of the subtree
+     */
+    unsigned int recomputeMaxFreq(uint32_t ptr);
+
+    /* return: freq + delta, kept between 0 and UINT_MAX */
+    static unsigned int addClamped(unsigned int freq, long long delta);
+
+    /* helper method for erase. Unlinks the nodes at the bottom of
+       insertPath that lead to no word any more, and takes them off the
+       path.
+     */
+    void pruneDeadNodes();
+
+    /* helper method for eraseAll. Erases the words [lo, hi) of sorted
+       from the sibling chain rooted at ptr, unlinking the nodes on their
+       way that lead to no word any more and recomputing the maxFreq of
+       the others, bottom up, where an erased word may have set it.
+       arguments: the root of the chain, the sorted words, which share
+       their first depth letters and are longer than depth, the number of
+       words erased so far, the largest frequency erased so far
+       return: the root of what is left of the chain
+     */
+    uint32_t eraseSorted(uint32_t ptr, const vector<string_view>& sorted,
+                         size_t lo, size_t hi, size_t depth, size_t& erased,
+                         unsigned int& lost);
+
+    /* Take a node out of its sibling chain, keeping the chain in order.
+       return: the node to link in its place
+     */
+    uint32_t spliceOut(uint32_t ptr);
+
+    /* Give a node that was unlinked back to the node arena */
+    void releaseNode(uint32_t ptr);
+
+    /* helper method for addFrequencies. Recomputes maxFreq and the
+       precomputed lists, and leaves the pattern index out, once the
+       frequencies have changed.
+     */
+    void repairFrequencies();
+
+    /* helper method for precomputeCompletions. Stores the list of every
+       precomputed prefix in the sibling chain rooted at ptr.
+       arguments: the root of the chain, the letters above it
+       return: the best completions of the whole chain
+     */
+    vector<uint32_t> precomputeLevel(uint32_t ptr, string& path);
+
+    /* return: true if word id1 comes before word id2 in the completions */
+    bool betterWord(uint32_t id1, uint32_t id2) const;
+
+    /* Append a list of word ids to the precomputed lists.
+       return: the list number
+     */
+    uint32_t storeList(vector<uint32_t>& best);
+
+    /* Offer a new word to the list with the given number */
+    void offerWord(uint32_t list, uint32_t id);
+
+    /* Add a newly inserted word, with the given id, to the precomputed
+       lists
+     */
+    void updatePrecomputed(string_view word, uint32_t id);
+
+    /* Move a word whose frequency changed within the precomputed lists of
+       its prefixes. A list it drops out of is searched again if it was
+       full, since the next best word may not be in it.
+       arguments: the word, its id, true if its frequency dropped
+     */
+    void reorderPrecomputed(string_view word, uint32_t id, bool dropped);
+
+    /* helper method for averageDepth. Adds up the search depth of every word
+       in the subtree and counts the words.
+     */
+    void sumDepths(uint32_t ptr, size_t depth, size_t& total,
+                   size_t& words) const;
 
     /* traverse through the subtree with given root, prune the branch if the
-      root of that branch fail to meet the requirement of being pushed to PQ
+      root of that branch fail to meet the requirement of being pushed to the
+      heap
         arguments: the root of the subtree,
-        a path showing how to reach the parent of the root, or empty if no
-      parent,
-        a piority queue to store all of the words,
-        the max size of PQ, which equals to numCompletions
-     */
-    void dfs(Node* ptr, string path,
-             priority_queue<pair<int, string>, vector<pair<int, string>>,
-                            CompFreq>& q,
-             int k);
-
-    /* helper method for predictUnderscore, so that we could fill in the
-       underscore and recursive down. arguments: subpattern (ignore the part
-       before the undersocre we just filled in)， a pointer pointing to node the
-       lettter of which is used to fill in the underscore a priority_queue used
-       to store the completions k (numOfCompletions) determines the max-size of
-       PQ we want, in order to improve efficiency
-     */
-    void underscoreHelper(
-        string pattern, Node* ptr,
-        priority_queue<pair<int, string>, vector<pair<int, string>>, CompFreq>&
-            q,
-        int k);
+        the max size of the heap, which equals to numCompletions,
+        the buffers of the search: scratch.path holds the prefix shared by
+      every word in the subtree (the letters above the root, without the
+      root's own letter), and the best words so far are in scratch.heap
+     */
+    void dfs(uint32_t ptr, unsigned int k, SearchScratch& scratch) const;
+
+    /* helper method for dfs. Offers the word with the given id to the
+       heap of the best k words.
+     */
+    void offerCandidate(uint32_t word, unsigned int k,
+                        SearchScratch& scratch) const;
+
+    /* helper method for dfs, matchPattern and matchAutomaton.
+       return: true if the heap of the best k words is full and no word of
+       a subtree with the given maxFreq, below the letters in scratch.path,
+       could enter it
+     */
+    bool pruned(unsigned int maxFreq, unsigned int k,
+                const SearchScratch& scratch) const;
+
+    /* helper method for dfs, matchPattern and matchAutomaton. Orders the
+       present ones of three branches by decreasing key, keeping their order
+       on equal keys.
+       return: the number of present branches, whose positions are then at
+       the front of order
+     */
+    static int orderByKey(const unsigned int keys[3], const bool present[3],
+                          int order[3]);
+
+    /* helper method for predictUnderscores.
+       return: true if the pattern is better matched with the pattern index
+       than by the trie walk
+     */
+    bool usePatternIndex(const string& pattern) const;
+
+    /* helper method for predictUnderscores. Matches the pattern letter
+       after the ones in scratch.path against the sibling chain rooted at
+       ptr, and offers the matching words to the heap of the best k words.
+       A subtree is skipped once its maxFreq cannot beat the heap, and a
+       branch once it cannot end a word at the length of the pattern.
+       arguments: the root of the chain, the pattern, the max size of the
+       heap, the buffers of the search
+     */
+    void matchPattern(uint32_t ptr, const string& pattern, unsigned int k,
+                      SearchScratch& scratch) const;
+
+    /* helper method for matchPattern. Matches the rest of the pattern below
+       the node ptr, whose letter matched.
+     */
+    void matchNode(uint32_t ptr, const string& pattern, unsigned int k,
+                   SearchScratch& scratch) const;
+
+    /* helper method for predictFuzzy. Walks the subtree rooted at ptr and
+       offers the words close enough to the prefix to the heap of the best
+       k fuzzy completions. Like dfs, scratch.path holds the letters above
+       ptr, and scratch.rows holds their rows of edit distances.
+       arguments: the root of the subtree, the prefix, the most edits
+       allowed, the fewest edits between the prefix and a prefix of
+       scratch.path, the max size of the heap, the buffers of the search
+     */
+    void fuzzyWalk(uint32_t ptr, const string& prefix, unsigned int maxEdits,
+                   unsigned int bestEdits, unsigned int k,
+                   SearchScratch& scratch) const;
+
+    /* helper method for fuzzyWalk. Computes the row of edit distances of
+       a letter after the ones in scratch.path, from the rows above it.
+       return: the last entry of the row, the edits between the whole
+       prefix and scratch.path followed by the letter
+     */
+    static unsigned int editRow(const string& prefix, char letter,
+                                SearchScratch& scratch);
+
+    /* helper method for fuzzyWalk.
+       return: true if the heap of the best k fuzzy completions is full and
+       no word of a subtree, at least the given edits away, with the given
+       maxFreq and below the letters in scratch.path, could enter it
+     */
+    bool fuzzyPruned(unsigned int edits, unsigned int maxFreq, unsigned int k,
+                     const SearchScratch& scratch) const;
+
+    /* helper method for predictPattern. Runs the automaton over the subtree
+       rooted at ptr, and offers the words it accepts to the heap of the
+       best k words. Like dfs, scratch.path holds the letters above ptr.
+       arguments: the root of the subtree, the states of the automaton
+       after the letters above it, the automaton, the max size of the heap,
+       the buffers of the search
+     */
+    void matchAutomaton(uint32_t ptr, uint64_t states,
+                        const PatternAutomaton& automaton, unsigned int k,
+                        SearchScratch& scratch) const;
 };
 
 #endif  // DICTIONARY_TRIE_HPP
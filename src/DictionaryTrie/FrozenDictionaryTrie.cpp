@@ -0,0 +1,538 @@
+/**
+ * This File shows the implementation details of
+ * FrozenDictionaryTrie class methods, which are declared
+ * in "FrozenDictionaryTrie.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "FrozenDictionaryTrie.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+const uint32_t FrozenDictionaryTrie::NO_WORD;
+const char FrozenDictionaryTrie::SNAPSHOT_MAGIC[8] = {'D', 'T', 'F', 'R',
+                                                       'O', 'Z', 'E', 'N'};
+const uint32_t FrozenDictionaryTrie::SNAPSHOT_VERSION;
+const uint32_t FrozenDictionaryTrie::BYTE_ORDER_MARK;
+
+/* the order of candidates: higher frequency first, then the byte order of
+    their text
+ */
+static bool better(const pair<uint32_t, uint32_t>& c1,
+                   const pair<uint32_t, uint32_t>& c2) {
+    if (c1.first == c2.first) {
+        return c1.second < c2.second;
+    }
+    return c1.first > c2.first;
+}
+
+/* Freeze a copy of the given trie */
+FrozenDictionaryTrie::FrozenDictionaryTrie(const DictionaryTrie& trie)
+    : mapping(nullptr), mappingSize(0) {
+    static_assert(sizeof(Node) % sizeof(uint32_t) == 0,
+                  "frozen nodes must fill whole words of the storage");
+    Layout layout;
+    layout.wordOf.assign(trie.nodes.maxIndex() + 1, NO_WORD);
+    layout.nodes.reserve(trie.nodes.size());
+
+    // number the words in byte order, then lay the nodes out depth first
+    string path;
+    numberWords(trie, trie.root, path, layout);
+    layout.offsets.push_back((uint32_t)layout.pool.size());
+    renumberWords(layout);
+    if (trie.root != 0) {
+        placeNodes(trie, trie.root, layout);
+    }
+
+    // copy everything into one block of storage
+    size_t numNodes = layout.nodes.size();
+    size_t numWords = layout.freqs.size();
+    size_t nodeWords = numNodes * sizeof(Node) / sizeof(uint32_t);
+    size_t poolWords = (layout.pool.size() + 3) / 4;
+    storage.assign(sizeof(Header) / sizeof(uint32_t) + nodeWords + numWords +
+                       (numWords + 1) + poolWords,
+                   0);
+    Header* h = reinterpret_cast<Header*>(storage.data());
+    memcpy(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic));
+    h->version = SNAPSHOT_VERSION;
+    h->byteOrder = BYTE_ORDER_MARK;
+    h->numNodes = (uint32_t)numNodes;
+    h->numWords = (uint32_t)numWords;
+    h->poolSize = (uint32_t)layout.pool.size();
+    bindStorage(storage.data(), storage.size() * sizeof(uint32_t));
+    // an empty vector may have no data to copy from at all
+    if (numNodes > 0) {
+        memcpy(const_cast<Node*>(nodes), layout.nodes.data(),
+               numNodes * sizeof(Node));
+    }
+    if (numWords > 0) {
+        memcpy(const_cast<uint32_t*>(freqs), layout.freqs.data(),
+               numWords * sizeof(uint32_t));
+    }
+    memcpy(const_cast<uint32_t*>(offsets), layout.offsets.data(),
+           (numWords + 1) * sizeof(uint32_t));
+    if (layout.pool.size() > 0) {
+        memcpy(const_cast<char*>(pool), layout.pool.data(),
+               layout.pool.size());
+    }
+}
+
+/* It is the constructor used by open */
+FrozenDictionaryTrie::FrozenDictionaryTrie()
+    : mapping(nullptr), mappingSize(0) {}
+
+/* Open a snapshot file written by save.
+    arguments: the snapshot file name
+    return: the trie, or nullptr if the file is not a valid snapshot
+ */
+FrozenDictionaryTrie* FrozenDictionaryTrie::open(const string& fileName) {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = (size_t)st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    FrozenDictionaryTrie* trie = new FrozenDictionaryTrie();
+    trie->mapping = mapped;
+    trie->mappingSize = size;
+    const Header* h = static_cast<const Header*>(mapped);
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != SNAPSHOT_VERSION || h->byteOrder != BYTE_ORDER_MARK ||
+        !trie->bindStorage(mapped, size) || !trie->checkStorage()) {
+        delete trie;
+        return nullptr;
+    }
+    return trie;
+}
+
+/* return: true if the file starts like a snapshot of this version */
+bool FrozenDictionaryTrie::isSnapshot(const string& fileName) {
+    ifstream in(fileName, ios::binary);
+    Header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        return false;
+    }
+    return memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) == 0 &&
+           h.version == SNAPSHOT_VERSION && h.byteOrder == BYTE_ORDER_MARK;
+}
+
+/* Save the trie as a snapshot file.
+    arguments: the snapshot file name
+    return: true if the whole snapshot was written
+ */
+bool FrozenDictionaryTrie::save(const string& fileName) const {
+    ofstream out(fileName, ios::binary | ios::trunc);
+    out.write(static_cast<const char*>(block()), memoryUsage());
+    out.close();
+    return !out.fail();
+}
+
+/* This is the destructor. Unmaps the snapshot if there is one */
+FrozenDictionaryTrie::~FrozenDictionaryTrie() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+/* This is the function to find whether the word is in the trie.
+    arguments: the target word
+    return true if the word is found, false otherwise
+ */
+bool FrozenDictionaryTrie::find(const string& word) const {
+    uint32_t ptr;
+    if (!descend(word, ptr)) {
+        return false;
+    }
+    return nodes[ptr].word != NO_WORD;
+}
+
+/* Use frequency to complete the predict completions.
+    arguments: prefix, number of completions return.
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> FrozenDictionaryTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
+    TopK topK(numCompletions);
+    if (numCompletions == 0 || header->numNodes == 0) {
+        return vector<string>();
+    }
+
+    if (prefix.length() == 0) {
+        collect(0, topK);
+    } else {
+        uint32_t ptr;
+        if (!descend(prefix, ptr)) {
+            // no completion exists
+            return vector<string>();
+        }
+        const Node& node = nodes[ptr];
+        if (node.word != NO_WORD) {
+            topK.offer(freqs[node.word], node.word);
+        }
+        if (node.hasMid) {
+            collect(ptr + 1, topK);
+        }
+    }
+    return toStrings(topK);
+}
+
+/* function for wildcard prediction
+    arguments: pattern with (or without) underscore(s)
+                number of completions desired
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> FrozenDictionaryTrie::predictUnderscores(
+    const string& pattern, unsigned int numCompletions) const {
+    TopK topK(numCompletions);
+    if (numCompletions == 0 || header->numNodes == 0 ||
+        pattern.length() == 0) {
+        return vector<string>();
+    }
+    matchPattern(pattern, 0, 0, topK);
+    return toStrings(topK);
+}
+
+/* return: the number of nodes in the trie */
+size_t FrozenDictionaryTrie::nodeCount() const { return header->numNodes; }
+
+/* return: the number of bytes of the frozen storage */
+size_t FrozenDictionaryTrie::memoryUsage() const {
+    if (mapping != nullptr) {
+        return mappingSize;
+    }
+    return storage.size() * sizeof(uint32_t);
+}
+
+/* return: true if a word with this frequency and number would enter the
+    heap
+ */
+bool FrozenDictionaryTrie::TopK::admits(uint32_t freq, uint32_t word) const {
+    return heap.size() < k || better(Candidate(freq, word), heap.front());
+}
+
+/* return: true if some word of a subtree with this maxFreq and first word
+    number could enter the heap
+ */
+bool FrozenDictionaryTrie::TopK::admitsSubtree(uint32_t maxFreq,
+                                               uint32_t firstWord) const {
+    return admits(maxFreq, firstWord);
+}
+
+/* Offer a word to the heap. The worst candidate is kept at the front. */
+void FrozenDictionaryTrie::TopK::offer(uint32_t freq, uint32_t word) {
+    if (!admits(freq, word)) {
+        return;
+    }
+    if (heap.size() == k) {
+        pop_heap(heap.begin(), heap.end(), better);
+        heap.pop_back();
+    }
+    heap.push_back(Candidate(freq, word));
+    push_heap(heap.begin(), heap.end(), better);
+}
+
+/* return: the word numbers from the best to the worst */
+vector<uint32_t> FrozenDictionaryTrie::TopK::drain() {
+    sort(heap.begin(), heap.end(), better);
+    vector<uint32_t> words;
+    for (const Candidate& c : heap) {
+        words.push_back(c.second);
+    }
+    heap.clear();
+    return words;
+}
+
+/* Number the words of the source subtree rooted at ptr in the letter
+    order of the TST: left subtree, this node, mid subtree, right subtree.
+ */
+void FrozenDictionaryTrie::numberWords(const DictionaryTrie& trie,
+                                       uint32_t ptr, string& path,
+                                       Layout& layout) {
+    if (ptr == 0) {
+        return;
+    }
+    const DictionaryTrie::Node& node = trie.nodes[ptr];
+    numberWords(trie, node.left, path, layout);
+    path.push_back(node.letter);
+    uint32_t word = node.word;
+    if (word != 0) {
+        layout.wordOf[ptr] = (uint32_t)layout.freqs.size();
+        layout.freqs.push_back(trie.words.freq(word));
+        layout.offsets.push_back((uint32_t)layout.pool.size());
+        layout.pool += path;
+    }
+    numberWords(trie, node.mid, path, layout);
+    path.pop_back();
+    numberWords(trie, node.right, path, layout);
+}
+
+/* Number the words again in the byte order of their text, the order in
+    which DictionaryTrie breaks ties in frequency. The walk of the TST
+    compares signed letters, so the two orders only differ on letters from
+    0x80 up, and for other dictionaries nothing moves.
+ */
+void FrozenDictionaryTrie::renumberWords(Layout& layout) {
+    size_t numWords = layout.freqs.size();
+    auto text = [&layout](uint32_t w) {
+        return string_view(layout.pool).substr(
+            layout.offsets[w], layout.offsets[w + 1] - layout.offsets[w]);
+    };
+    auto byText = [&text](uint32_t w1, uint32_t w2) {
+        return text(w1) < text(w2);
+    };
+    vector<uint32_t> order(numWords);
+    iota(order.begin(), order.end(), 0);
+    if (is_sorted(order.begin(), order.end(), byText)) {
+        return;
+    }
+    sort(order.begin(), order.end(), byText);
+
+    vector<uint32_t> numberOf(numWords);
+    vector<uint32_t> freqs;
+    vector<uint32_t> offsets;
+    string pool;
+    pool.reserve(layout.pool.size());
+    for (uint32_t n = 0; n < numWords; n++) {
+        numberOf[order[n]] = n;
+        freqs.push_back(layout.freqs[order[n]]);
+        offsets.push_back((uint32_t)pool.size());
+        pool += text(order[n]);
+    }
+    offsets.push_back((uint32_t)pool.size());
+    for (uint32_t& word : layout.wordOf) {
+        if (word != NO_WORD) {
+            word = numberOf[word];
+        }
+    }
+    layout.freqs.swap(freqs);
+    layout.offsets.swap(offsets);
+    layout.pool.swap(pool);
+}
+
+/* Append the source subtree rooted at ptr to the node array: this node,
+    then its mid, left and right subtrees.
+    return: the index of the subtree root in the node array
+ */
+uint32_t FrozenDictionaryTrie::placeNodes(const DictionaryTrie& trie,
+                                          uint32_t ptr, Layout& layout) {
+    const DictionaryTrie::Node& src = trie.nodes[ptr];
+    uint32_t pos = (uint32_t)layout.nodes.size();
+    layout.nodes.push_back(Node());
+
+    uint32_t firstWord = layout.wordOf[ptr];
+    uint32_t children[3] = {0, 0, 0};
+    uint32_t sources[3] = {src.mid, src.left, src.right};
+    for (int i = 0; i < 3; i++) {
+        if (sources[i] != 0) {
+            children[i] = placeNodes(trie, sources[i], layout);
+            firstWord = min(firstWord, layout.nodes[children[i]].firstWord);
+        }
+    }
+
+    Node& node = layout.nodes[pos];
+    node.left = children[1];
+    node.right = children[2];
+    node.maxFreq = src.maxFreq;
+    node.firstWord = firstWord;
+    node.word = layout.wordOf[ptr];
+    node.letter = src.letter;
+    node.hasMid = src.mid != 0;
+    return pos;
+}
+
+/* Point the array pointers at their place in the given block.
+    arguments: the block and its size in bytes
+    return: false if the block is too small for the sizes in its header
+ */
+bool FrozenDictionaryTrie::bindStorage(const void* block, size_t size) {
+    const uint32_t* p = static_cast<const uint32_t*>(block);
+    header = reinterpret_cast<const Header*>(p);
+    uint64_t needed = sizeof(Header) +
+                      (uint64_t)header->numNodes * sizeof(Node) +
+                      ((uint64_t)header->numWords * 2 + 1) * sizeof(uint32_t) +
+                      header->poolSize;
+    if (needed > size) {
+        return false;
+    }
+    p += sizeof(Header) / sizeof(uint32_t);
+    nodes = reinterpret_cast<const Node*>(p);
+    p += header->numNodes * sizeof(Node) / sizeof(uint32_t);
+    freqs = p;
+    p += header->numWords;
+    offsets = p;
+    p += header->numWords + 1;
+    pool = reinterpret_cast<const char*>(p);
+    return offsets[header->numWords] == header->poolSize;
+}
+
+/* Check that every index in the bound arrays stays inside them: the
+    children of a node come after it, which also rules out cycles, the words
+    are numbered and the offsets run up to the end of the pool.
+    return: false if a query could read outside the arrays
+ */
+bool FrozenDictionaryTrie::checkStorage() const {
+    uint32_t numNodes = header->numNodes;
+    uint32_t numWords = header->numWords;
+    for (uint32_t i = 0; i < numNodes; i++) {
+        const Node& node = nodes[i];
+        if ((node.left != 0 && (node.left <= i || node.left >= numNodes)) ||
+            (node.right != 0 &&
+             (node.right <= i || node.right >= numNodes)) ||
+            (node.hasMid && i + 1 >= numNodes) ||
+            (node.word != NO_WORD && node.word >= numWords)) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < numWords; i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return offsets[numWords] == header->poolSize;
+}
+
+/* return: a pointer to the first byte of the frozen block */
+const void* FrozenDictionaryTrie::block() const { return header; }
+
+/* return: the text of the given word */
+string FrozenDictionaryTrie::wordText(uint32_t word) const {
+    return string(pool + offsets[word], offsets[word + 1] - offsets[word]);
+}
+
+/* Turn the heap into the list of completions */
+vector<string> FrozenDictionaryTrie::toStrings(TopK& topK) const {
+    vector<string> results;
+    for (uint32_t word : topK.drain()) {
+        results.push_back(wordText(word));
+    }
+    return results;
+}
+
+/* Walk down to the node of the last letter of a non-empty prefix.
+    return: true if the prefix is in the trie
+ */
+bool FrozenDictionaryTrie::descend(const string& prefix,
+                                   uint32_t& ptr) const {
+    if (prefix.length() == 0 || header->numNodes == 0) {
+        return false;
+    }
+    uint32_t p = 0;
+    size_t i = 0;
+    while (true) {
+        const Node& node = nodes[p];
+        char letter = prefix[i];
+        if (letter < node.letter) {
+            if (node.left == 0) {
+                return false;
+            }
+            p = node.left;
+        } else if (letter > node.letter) {
+            if (node.right == 0) {
+                return false;
+            }
+            p = node.right;
+        } else {
+            i++;
+            if (i == prefix.length()) {
+                ptr = p;
+                return true;
+            }
+            if (!node.hasMid) {
+                return false;
+            }
+            p = p + 1;
+        }
+    }
+}
+
+/* depth first top-k search of the subtree rooted at ptr. Children are
+    visited by decreasing maxFreq so the heap fills with good words early
+    and prunes the rest.
+ */
+void FrozenDictionaryTrie::collect(uint32_t ptr, TopK& topK) const {
+    const Node& node = nodes[ptr];
+    if (!topK.admitsSubtree(node.maxFreq, node.firstWord)) {
+        return;
+    }
+    if (node.word != NO_WORD) {
+        topK.offer(freqs[node.word], node.word);
+    }
+
+    uint32_t children[3];
+    int n = 0;
+    if (node.hasMid) {
+        children[n++] = ptr + 1;
+    }
+    if (node.left != 0) {
+        children[n++] = node.left;
+    }
+    if (node.right != 0) {
+        children[n++] = node.right;
+    }
+    sort(children, children + n, [this](uint32_t c1, uint32_t c2) {
+        return nodes[c1].maxFreq > nodes[c2].maxFreq;
+    });
+    for (int i = 0; i < n; i++) {
+        collect(children[i], topK);
+    }
+}
+
+/* match pattern[pos..] against the subtree rooted at ptr. An underscore
+    matches every letter of the sibling chain, any other letter follows
+    the usual descent.
+ */
+void FrozenDictionaryTrie::matchPattern(const string& pattern, size_t pos,
+                                        uint32_t ptr, TopK& topK) const {
+    while (true) {
+        const Node& node = nodes[ptr];
+        if (!topK.admitsSubtree(node.maxFreq, node.firstWord)) {
+            return;
+        }
+        char letter = pattern[pos];
+        bool wildcard = letter == '_';
+        if (wildcard || letter == node.letter) {
+            if (wildcard && node.left != 0) {
+                matchPattern(pattern, pos, node.left, topK);
+            }
+            if (pos + 1 == pattern.length()) {
+                if (node.word != NO_WORD) {
+                    topK.offer(freqs[node.word], node.word);
+                }
+            } else if (node.hasMid) {
+                matchPattern(pattern, pos + 1, ptr + 1, topK);
+            }
+            if (!wildcard || node.right == 0) {
+                return;
+            }
+            ptr = node.right;
+        } else if (letter < node.letter) {
+            if (node.left == 0) {
+                return;
+            }
+            ptr = node.left;
+        } else {
+            if (node.right == 0) {
+                return;
+            }
+            ptr = node.right;
+        }
+    }
+}
@@ -0,0 +1,234 @@
+/**
+ * This file declares the structure of FrozenDictionaryTrie class, an
+ * immutable copy of a DictionaryTrie laid out for fast queries.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef FROZEN_DICTIONARY_TRIE_HPP
+#define FROZEN_DICTIONARY_TRIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * A read-only ternary search tree frozen from a populated DictionaryTrie.
+ * The nodes sit in one array in depth-first order (node, mid subtree, left
+ * subtree, right subtree), so the mid child of a node is always the next
+ * node and a descent mostly walks forward through memory.
+ * Words are numbered in the byte order of their text and their text and
+ * frequencies are kept in flat side arrays, so the top-k search compares
+ * numbers instead of strings and breaks ties in frequency the way
+ * DictionaryTrie does.
+ */
+class FrozenDictionaryTrie {
+  private:
+    /** a node of the frozen TST */
+    struct Node {
+        // index of the left/right child, 0 if absent (the root is never a
+        // left or right child)
+        uint32_t left;
+        uint32_t right;
+        // the largest frequency in the subtree (with left and right)
+        uint32_t maxFreq;
+        // the smallest word number in the subtree (with left and right)
+        uint32_t firstWord;
+        // the number of the word ending at this node, or NO_WORD
+        uint32_t word;
+        char letter;
+        // true if the mid child is the next node
+        bool hasMid;
+    };
+
+    /** the header at the start of the frozen storage and of a snapshot */
+    struct Header {
+        // SNAPSHOT_MAGIC
+        char magic[8];
+        // SNAPSHOT_VERSION
+        uint32_t version;
+        // BYTE_ORDER_MARK as written by the machine that saved the file
+        uint32_t byteOrder;
+        uint32_t numNodes;
+        uint32_t numWords;
+        uint32_t poolSize;
+    };
+
+    static const uint32_t NO_WORD = 0xffffffffu;
+    static const char SNAPSHOT_MAGIC[8];
+    // bump whenever the layout of Header or Node changes
+    static const uint32_t SNAPSHOT_VERSION = 1;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    // owns the header followed by the node, frequency, offset and text
+    // arrays, unless they are mapped from a snapshot
+    vector<uint32_t> storage;
+    // the mapped snapshot, or nullptr
+    void* mapping;
+    size_t mappingSize;
+
+    const Header* header;
+    const Node* nodes;
+    // frequency of each word
+    const uint32_t* freqs;
+    // word i is the text [offsets[i], offsets[i + 1]) of the pool
+    const uint32_t* offsets;
+    const char* pool;
+
+  public:
+    /* Freeze a copy of the given trie. Later changes to the trie are not
+        seen by the frozen copy.
+     */
+    explicit FrozenDictionaryTrie(const DictionaryTrie& trie);
+
+    FrozenDictionaryTrie(const FrozenDictionaryTrie&) = delete;
+    FrozenDictionaryTrie& operator=(const FrozenDictionaryTrie&) = delete;
+
+    /* Open a snapshot file written by save. The file is mapped read-only
+        and queried in place.
+        arguments: the snapshot file name
+        return: the trie, or nullptr if the file is not a valid snapshot
+     */
+    static FrozenDictionaryTrie* open(const string& fileName);
+
+    /* return: true if the file starts like a snapshot of this version */
+    static bool isSnapshot(const string& fileName);
+
+    /* Save the trie as a snapshot file.
+        arguments: the snapshot file name
+        return: true if the whole snapshot was written
+     */
+    bool save(const string& fileName) const;
+
+    /* This is the function to find whether the word is in the trie.
+        arguments: the target word
+        return true if the word is found, false otherwise
+     */
+    bool find(const string& word) const;
+
+    /* Use frequency to complete the predict completions.
+        arguments: prefix, number of completions return.
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* function for wildcard prediction
+        arguments: pattern with (or without) underscore(s)
+                    number of completions desired
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const;
+
+    /* return: the number of nodes in the trie */
+    size_t nodeCount() const;
+
+    /* return: the number of bytes of the frozen storage */
+    size_t memoryUsage() const;
+
+    /* This is the destructor. Unmaps the snapshot if there is one */
+    ~FrozenDictionaryTrie();
+
+  private:
+    /* It is the constructor used by open */
+    FrozenDictionaryTrie();
+
+    /** a candidate completion: frequency and word number */
+    typedef pair<uint32_t, uint32_t> Candidate;
+
+    /** a bounded heap of the best k candidates seen so far */
+    class TopK {
+      public:
+        explicit TopK(unsigned int k) : k(k) {}
+
+        /* return: true if a word with this frequency and number would
+            enter the heap
+         */
+        bool admits(uint32_t freq, uint32_t word) const;
+
+        /* return: true if some word of a subtree with this maxFreq and
+            first word number could enter the heap
+         */
+        bool admitsSubtree(uint32_t maxFreq, uint32_t firstWord) const;
+
+        /* Offer a word to the heap */
+        void offer(uint32_t freq, uint32_t word);
+
+        /* return: the word numbers from the best to the worst */
+        vector<uint32_t> drain();
+
+      private:
+        unsigned int k;
+        vector<Candidate> heap;
+    };
+
+    /** the arrays collected while freezing a trie */
+    struct Layout {
+        // word number of each node of the source trie, or NO_WORD
+        vector<uint32_t> wordOf;
+        vector<Node> nodes;
+        vector<uint32_t> freqs;
+        vector<uint32_t> offsets;
+        string pool;
+    };
+
+    /* Number the words of the source subtree rooted at ptr in the letter
+        order of the TST and append their text to the pool.
+        arguments: the source trie, the subtree, the letters above it
+     */
+    static void numberWords(const DictionaryTrie& trie, uint32_t ptr,
+                            string& path, Layout& layout);
+
+    /* Number the words in the byte order of their text instead of the
+        letter order of the TST, and move their text and frequencies along
+     */
+    static void renumberWords(Layout& layout);
+
+    /* Append the source subtree rooted at ptr to the node array in
+        depth-first order.
+        return: the index of the subtree root in the node array
+     */
+    static uint32_t placeNodes(const DictionaryTrie& trie, uint32_t ptr,
+                               Layout& layout);
+
+    /* Point the array pointers at their place in the given block.
+        arguments: the block and its size in bytes
+        return: false if the block is too small for the sizes in its header
+     */
+    bool bindStorage(const void* block, size_t size);
+
+    /* Check that every index in the bound arrays stays inside them: the
+        children of a node come after it, the words are numbered and the
+        offsets run up to the end of the pool.
+        return: false if a query could read outside the arrays
+     */
+    bool checkStorage() const;
+
+    /* return: a pointer to the first byte of the frozen block */
+    const void* block() const;
+
+    /* return: the text of the given word */
+    string wordText(uint32_t word) const;
+
+    /* Turn the heap into the list of completions */
+    vector<string> toStrings(TopK& topK) const;
+
+    /* Walk down to the node of the last letter of a non-empty prefix.
+        return: true if the prefix is in the trie
+     */
+    bool descend(const string& prefix, uint32_t& ptr) const;
+
+    /* depth first top-k search of the subtree rooted at ptr */
+    void collect(uint32_t ptr, TopK& topK) const;
+
+    /* match pattern[pos..] against the subtree rooted at ptr */
+    void matchPattern(const string& pattern, size_t pos, uint32_t ptr,
+                      TopK& topK) const;
+};
+
+#endif  // FROZEN_DICTIONARY_TRIE_HPP
@@ -0,0 +1,375 @@
+/**
+ * This File shows the implementation details of
+ * MinimizedDictionaryTrie class methods, which are declared
+ * in "MinimizedDictionaryTrie.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "MinimizedDictionaryTrie.hpp"
+#include <algorithm>
+#include <cstring>
+
+// the mark of a draft state that is not placed yet
+static const uint32_t NOT_PLACED = 0xffffffffu;
+
+/* Build the minimized automaton of the words of the given trie. */
+MinimizedDictionaryTrie::MinimizedDictionaryTrie(const DictionaryTrie& trie) {
+    // the words go in in byte order, which numbers them the way
+    // DictionaryTrie breaks ties and lets every state below the last
+    // word's prefix be minimized for good. The TST walk compares signed
+    // letters, so only words with letters from 0x80 up need sorting.
+    vector<pair<string, unsigned int>> words;
+    string path;
+    collectWords(trie, trie.root, path, words);
+    if (!is_sorted(words.begin(), words.end())) {
+        sort(words.begin(), words.end());
+    }
+    Builder builder;
+    builder.drafts.push_back(Draft{false, {}});
+    builder.path.push_back(0);
+    for (const pair<string, unsigned int>& word : words) {
+        addWord(builder, word.first);
+        freqs.push_back(word.second);
+    }
+    minimize(builder, 0);
+    if (freqs.empty()) {
+        return;
+    }
+
+    // lay the states out depth first, then find their maxFreq with one walk
+    // over every prefix
+    vector<uint32_t> placed(builder.drafts.size(), NOT_PLACED);
+    vector<uint32_t> counts;
+    placeState(builder, 0, placed, counts);
+    raiseMaxFreq(0, 0);
+    states.shrink_to_fit();
+    edges.shrink_to_fit();
+    freqs.shrink_to_fit();
+}
+
+/* This is the function to find whether the word is in the trie.
+    arguments: the target word
+    return true if the word is found, false otherwise
+ */
+bool MinimizedDictionaryTrie::find(const string& word) const {
+    if (states.empty() || word.length() == 0) {
+        return false;
+    }
+    uint32_t state = 0;
+    for (char letter : word) {
+        const Edge* edge = edgeOf(states[state], letter);
+        if (edge == nullptr) {
+            return false;
+        }
+        state = edge->target;
+    }
+    return states[state].final;
+}
+
+/* Use frequency to complete the predict completions.
+    arguments: prefix, number of completions return.
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> MinimizedDictionaryTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    if (states.empty() || numCompletions == 0) {
+        return drain(heap);
+    }
+    // the number of the first word below the prefix adds up on the way
+    uint32_t state = 0;
+    uint32_t first = 0;
+    for (char letter : prefix) {
+        const Edge* edge = edgeOf(states[state], letter);
+        if (edge == nullptr) {
+            return drain(heap);
+        }
+        first += edge->skip;
+        state = edge->target;
+    }
+    collect(state, first, numCompletions, heap);
+    return drain(heap);
+}
+
+/* function for wildcard prediction
+    arguments: pattern with (or without) underscore(s)
+                number of completions desired
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> MinimizedDictionaryTrie::predictUnderscores(
+    const string& pattern, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    if (!states.empty() && pattern.length() > 0 && numCompletions > 0) {
+        matchPattern(0, 0, pattern, 0, numCompletions, heap);
+    }
+    return drain(heap);
+}
+
+/* return: the number of states of the automaton */
+size_t MinimizedDictionaryTrie::nodeCount() const { return states.size(); }
+
+/* return: the number of edges of the automaton */
+size_t MinimizedDictionaryTrie::edgeCount() const { return edges.size(); }
+
+/* return: the number of bytes reserved for the states, the edges and the
+    frequencies
+ */
+size_t MinimizedDictionaryTrie::memoryUsage() const {
+    return states.capacity() * sizeof(State) +
+           edges.capacity() * sizeof(Edge) +
+           freqs.capacity() * sizeof(unsigned int);
+}
+
+/* Collect the words of the source subtree rooted at ptr with their
+    frequencies, in the letter order of the TST: left subtree, this node,
+    mid subtree, right subtree.
+    arguments: the source trie, the subtree, the letters above it, the list
+    of words
+ */
+void MinimizedDictionaryTrie::collectWords(
+    const DictionaryTrie& trie, uint32_t ptr, string& path,
+    vector<pair<string, unsigned int>>& words) {
+    if (ptr == 0) {
+        return;
+    }
+    const DictionaryTrie::Node& node = trie.nodes[ptr];
+    collectWords(trie, node.left, path, words);
+    path.push_back(node.letter);
+    uint32_t word = node.word;
+    if (word != 0) {
+        words.push_back({path, trie.words.freq(word)});
+    }
+    collectWords(trie, node.mid, path, words);
+    path.pop_back();
+    collectWords(trie, node.right, path, words);
+}
+
+/* Add a word that comes after every word added so far. The states of the
+    last word below the prefix they share are minimized first, since no
+    later word can reach them.
+ */
+void MinimizedDictionaryTrie::addWord(Builder& builder, const string& word) {
+    size_t common = mismatch(word.begin(), word.end(), builder.last.begin(),
+                             builder.last.end())
+                        .first -
+                    word.begin();
+    minimize(builder, common);
+    for (size_t i = common; i < word.length(); i++) {
+        uint32_t draft = (uint32_t)builder.drafts.size();
+        builder.drafts.push_back(Draft{false, {}});
+        builder.drafts[builder.path.back()].edges.push_back({word[i], draft});
+        builder.path.push_back(draft);
+    }
+    builder.drafts[builder.path.back()].final = true;
+    builder.last = word;
+}
+
+/* Minimize the states of the last word after its first depth letters,
+    from the bottom up: each one is replaced by an equal known state, or
+    becomes known. Two states are equal if they are both final or not and
+    have the same edges, which point at minimized states already.
+ */
+void MinimizedDictionaryTrie::minimize(Builder& builder, size_t depth) {
+    while (builder.path.size() > depth + 1) {
+        uint32_t draft = builder.path.back();
+        builder.path.pop_back();
+        Draft& state = builder.drafts[draft];
+        string key(1, state.final ? '1' : '0');
+        for (const pair<char, uint32_t>& edge : state.edges) {
+            key.push_back(edge.first);
+            key.append(reinterpret_cast<const char*>(&edge.second),
+                       sizeof(edge.second));
+        }
+        auto found = builder.known.find(key);
+        if (found == builder.known.end()) {
+            builder.known.emplace(move(key), draft);
+        } else {
+            builder.drafts[builder.path.back()].edges.back().second =
+                found->second;
+            vector<pair<char, uint32_t>>().swap(state.edges);
+        }
+    }
+}
+
+/* Append a draft state and the ones below it to the states, each state
+    before the ones below it, and count the words of each. An edge skips
+    the final word of its state and the words of the edges before it.
+    return: the state of the draft
+ */
+uint32_t MinimizedDictionaryTrie::placeState(const Builder& builder,
+                                             uint32_t draft,
+                                             vector<uint32_t>& placed,
+                                             vector<uint32_t>& counts) {
+    if (placed[draft] != NOT_PLACED) {
+        return placed[draft];
+    }
+    const Draft& source = builder.drafts[draft];
+    uint32_t state = (uint32_t)states.size();
+    uint32_t firstEdge = (uint32_t)edges.size();
+    placed[draft] = state;
+    states.push_back(State{firstEdge, 0, (uint16_t)source.edges.size(),
+                           source.final});
+    counts.push_back(0);
+    edges.resize(edges.size() + source.edges.size());
+
+    uint32_t count = source.final ? 1 : 0;
+    for (size_t i = 0; i < source.edges.size(); i++) {
+        uint32_t target = placeState(builder, source.edges[i].second, placed,
+                                     counts);
+        edges[firstEdge + i] = Edge{target, count, source.edges[i].first};
+        count += counts[target];
+    }
+    counts[state] = count;
+    return state;
+}
+
+/* Raise the maxFreq of a state and the ones below it to the words that
+    reach them from one prefix. A state is visited once per prefix leading
+    to it, so the walk costs what the TST has nodes.
+    return: the largest frequency of these words
+ */
+unsigned int MinimizedDictionaryTrie::raiseMaxFreq(uint32_t state,
+                                                   uint32_t first) {
+    unsigned int maxFreq = states[state].final ? freqs[first] : 0;
+    uint32_t end = states[state].firstEdge + states[state].edgeCount;
+    for (uint32_t e = states[state].firstEdge; e < end; e++) {
+        maxFreq =
+            max(maxFreq, raiseMaxFreq(edges[e].target, first + edges[e].skip));
+    }
+    states[state].maxFreq = max(states[state].maxFreq, maxFreq);
+    return maxFreq;
+}
+
+/* return: the edge of a state for a letter, or nullptr if none. The edges
+    are in byte order, so the search stops at the first larger letter.
+ */
+const MinimizedDictionaryTrie::Edge* MinimizedDictionaryTrie::edgeOf(
+    const State& state, char letter) const {
+    const Edge* edge = edges.data() + state.firstEdge;
+    const Edge* end = edge + state.edgeCount;
+    for (; edge != end && (unsigned char)edge->letter <= (unsigned char)letter;
+         edge++) {
+        if (edge->letter == letter) {
+            return edge;
+        }
+    }
+    return nullptr;
+}
+
+/* return: the text of the word with the given number. At every state the
+    word is the final one or goes through the last edge skipping no more
+    than its number.
+ */
+string MinimizedDictionaryTrie::spell(uint32_t number) const {
+    string word;
+    uint32_t state = 0;
+    while (!(states[state].final && number == 0)) {
+        const Edge* edge = edges.data() + states[state].firstEdge;
+        const Edge* end = edge + states[state].edgeCount;
+        while (edge + 1 != end && edge[1].skip <= number) {
+            edge++;
+        }
+        number -= edge->skip;
+        word.push_back(edge->letter);
+        state = edge->target;
+    }
+    return word;
+}
+
+/* return: true if word n1 comes before n2 in the completions: the higher
+    frequency first, then the smaller number
+ */
+bool MinimizedDictionaryTrie::betterWord(uint32_t n1, uint32_t n2) const {
+    if (freqs[n1] != freqs[n2]) {
+        return freqs[n1] > freqs[n2];
+    }
+    return n1 < n2;
+}
+
+/* Offer a word to a heap of the best k words, the worst on top */
+void MinimizedDictionaryTrie::offerWord(uint32_t n, unsigned int k,
+                                        vector<uint32_t>& heap) const {
+    auto better = [this](uint32_t n1, uint32_t n2) {
+        return betterWord(n1, n2);
+    };
+    if (heap.size() < k) {
+        heap.push_back(n);
+        push_heap(heap.begin(), heap.end(), better);
+    } else if (betterWord(n, heap.front())) {
+        pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = n;
+        push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+/* return: true if no word through a state with this maxFreq can enter a
+    full heap of the best k words
+ */
+bool MinimizedDictionaryTrie::prunes(unsigned int maxFreq, unsigned int k,
+                                     const vector<uint32_t>& heap) const {
+    return heap.size() == k && maxFreq < freqs[heap.front()];
+}
+
+/* Turn a heap into the list of completions, best first */
+vector<string> MinimizedDictionaryTrie::drain(vector<uint32_t>& heap) const {
+    sort(heap.begin(), heap.end(), [this](uint32_t n1, uint32_t n2) {
+        return betterWord(n1, n2);
+    });
+    vector<string> results;
+    results.reserve(heap.size());
+    for (uint32_t n : heap) {
+        results.push_back(spell(n));
+    }
+    return results;
+}
+
+/* depth first top-k search of the words below a state, the first of them
+    numbered first, pruned by maxFreq
+ */
+void MinimizedDictionaryTrie::collect(uint32_t state, uint32_t first,
+                                      unsigned int k,
+                                      vector<uint32_t>& heap) const {
+    const State& s = states[state];
+    if (prunes(s.maxFreq, k, heap)) {
+        return;
+    }
+    if (s.final) {
+        offerWord(first, k, heap);
+    }
+    for (uint32_t e = s.firstEdge; e < s.firstEdge + s.edgeCount; e++) {
+        collect(edges[e].target, first + edges[e].skip, k, heap);
+    }
+}
+
+/* match pattern[pos..] against the words below a state, the first of them
+    numbered first
+ */
+void MinimizedDictionaryTrie::matchPattern(uint32_t state, uint32_t first,
+                                           const string& pattern, size_t pos,
+                                           unsigned int k,
+                                           vector<uint32_t>& heap) const {
+    const State& s = states[state];
+    if (prunes(s.maxFreq, k, heap)) {
+        return;
+    }
+    if (pos == pattern.length()) {
+        if (s.final) {
+            offerWord(first, k, heap);
+        }
+        return;
+    }
+    char letter = pattern[pos];
+    if (letter != '_') {
+        const Edge* edge = edgeOf(s, letter);
+        if (edge != nullptr) {
+            matchPattern(edge->target, first + edge->skip, pattern, pos + 1,
+                         k, heap);
+        }
+        return;
+    }
+    for (uint32_t e = s.firstEdge; e < s.firstEdge + s.edgeCount; e++) {
+        matchPattern(edges[e].target, first + edges[e].skip, pattern,
+                     pos + 1, k, heap);
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * This file declares the structure of MinimizedDictionaryTrie class, a
+ * minimized acyclic automaton built from a populated DictionaryTrie.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef MINIMIZED_DICTIONARY_TRIE_HPP
+#define MINIMIZED_DICTIONARY_TRIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * A read-only minimized deterministic acyclic automaton (DAFSA) holding the
+ * words of a DictionaryTrie. Where the trie keeps a subtree under every
+ * prefix, the automaton keeps one state per distinct set of endings, so the
+ * shared suffixes ("-ing", "-tion", plurals) are stored once.
+ * Words are numbered in the byte order of their text. Every edge knows how
+ * many words of its state come before the ones through it, so a walk adds
+ * up the number of the word it spells (a perfect hash), which indexes the
+ * frequencies, and a number is spelled back by the same walk. The text of
+ * the words is not stored at all.
+ * A state is shared by prefixes whose words have different frequencies, so
+ * its maxFreq is the largest frequency of any word through it, with any
+ * prefix. That is still an upper bound for the words below every prefix, so
+ * it prunes the top-k searches as in DictionaryTrie, only less tightly.
+ * Ties in frequency are broken by the word numbers, which is the order
+ * DictionaryTrie breaks them in.
+ */
+class MinimizedDictionaryTrie {
+  private:
+    /** a transition of the automaton */
+    struct Edge {
+        // the state it leads to
+        uint32_t target;
+        // the number of words of the state that come before the ones
+        // through this edge, added to the word number on the way down
+        uint32_t skip;
+        char letter;
+    };
+
+    /** a state of the automaton */
+    struct State {
+        // the edges are edges[firstEdge, firstEdge + edgeCount), in the
+        // byte order of their letters
+        uint32_t firstEdge;
+        // the largest frequency of the words through this state
+        unsigned int maxFreq;
+        uint16_t edgeCount;
+        // true if a word ends here
+        bool final;
+    };
+
+    /** a state of the automaton under construction */
+    struct Draft {
+        bool final;
+        vector<pair<char, uint32_t>> edges;
+    };
+
+    /** the automaton under construction, minimized as the words come in
+        byte order
+     */
+    struct Builder {
+        vector<Draft> drafts;
+        // the minimized states by their content, to find an equal one
+        unordered_map<string, uint32_t> known;
+        // the states spelling the last word, not minimized yet. path[i]
+        // is the state after i letters.
+        vector<uint32_t> path;
+        string last;
+    };
+
+    // the states, the first one the start of every word. Empty if there
+    // are no words.
+    vector<State> states;
+    vector<Edge> edges;
+    // frequency of each word, by word number
+    vector<unsigned int> freqs;
+
+  public:
+    /* Build the minimized automaton of the words of the given trie. Later
+        changes to the trie are not seen by the automaton.
+     */
+    explicit MinimizedDictionaryTrie(const DictionaryTrie& trie);
+
+    MinimizedDictionaryTrie(const MinimizedDictionaryTrie&) = delete;
+    MinimizedDictionaryTrie& operator=(const MinimizedDictionaryTrie&) =
+        delete;
+
+    /* This is the function to find whether the word is in the trie.
+        arguments: the target word
+        return true if the word is found, false otherwise
+     */
+    bool find(const string& word) const;
+
+    /* Use frequency to complete the predict completions.
+        arguments: prefix, number of completions return.
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* function for wildcard prediction
+        arguments: pattern with (or without) underscore(s)
+                    number of completions desired
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const;
+
+    /* return: the number of states of the automaton */
+    size_t nodeCount() const;
+
+    /* return: the number of edges of the automaton */
+    size_t edgeCount() const;
+
+    /* return: the number of bytes reserved for the states, the edges and
+        the frequencies
+     */
+    size_t memoryUsage() const;
+
+  private:
+    /* Collect the words of the source subtree rooted at ptr with their
+        frequencies, in the letter order of the TST.
+        arguments: the source trie, the subtree, the letters above it, the
+        list of words
+     */
+    static void collectWords(const DictionaryTrie& trie, uint32_t ptr,
+                             string& path,
+                             vector<pair<string, unsigned int>>& words);
+
+    /* Add a word that comes after every word added so far. The states of
+        the last word below the prefix they share are minimized first.
+     */
+    static void addWord(Builder& builder, const string& word);
+
+    /* Minimize the states of the last word after its first depth letters:
+        each one is replaced by an equal known state, or becomes known.
+     */
+    static void minimize(Builder& builder, size_t depth);
+
+    /* Append a draft state and the ones below it to the states, each
+        state before the ones below it, and count the words of each.
+        arguments: the builder, the draft, the state of each draft placed
+        so far, the number of words of each state
+        return: the state of the draft
+     */
+    uint32_t placeState(const Builder& builder, uint32_t draft,
+                        vector<uint32_t>& placed, vector<uint32_t>& counts);
+
+    /* Raise the maxFreq of a state and the ones below it to the words that
+        reach them from one prefix.
+        arguments: the state, the number of its first word from the prefix
+        return: the largest frequency of these words
+     */
+    unsigned int raiseMaxFreq(uint32_t state, uint32_t first);
+
+    /* return: the edge of a state for a letter, or nullptr if none */
+    const Edge* edgeOf(const State& state, char letter) const;
+
+    /* return: the text of the word with the given number */
+    string spell(uint32_t number) const;
+
+    /* return: true if word n1 comes before n2 in the completions: the
+        higher frequency first, then the smaller number
+     */
+    bool betterWord(uint32_t n1, uint32_t n2) const;
+
+    /* Offer a word to a heap of the best k words, the worst on top */
+    void offerWord(uint32_t n, unsigned int k, vector<uint32_t>& heap) const;
+
+    /* return: true if no word through a state with this maxFreq can enter
+        a full heap of the best k words
+     */
+    bool prunes(unsigned int maxFreq, unsigned int k,
+                const vector<uint32_t>& heap) const;
+
+    /* Turn a heap into the list of completions, best first */
+    vector<string> drain(vector<uint32_t>& heap) const;
+
+    /* depth first top-k search of the words below a state, the first of
+        them numbered first, pruned by maxFreq
+     */
+    void collect(uint32_t state, uint32_t first, unsigned int k,
+                 vector<uint32_t>& heap) const;
+
+    /* match pattern[pos..] against the words below a state, the first of
+        them numbered first
+     */
+    void matchPattern(uint32_t state, uint32_t first, const string& pattern,
+                      size_t pos, unsigned int k,
+                      vector<uint32_t>& heap) const;
+};
+
+#endif  // MINIMIZED_DICTIONARY_TRIE_HPP
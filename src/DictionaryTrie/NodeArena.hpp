@@ -0,0 +1,182 @@
+/**
+ * This file declares and implements NodeArena, a chunked bump-pointer
+ * allocator used by the tries to own their nodes.
+ *
+ * Nodes are carved out of large chunks one after another, so the nodes
+ * created by one load sit next to each other in memory, and releasing the
+ * arena frees whole chunks without visiting a single node. A node given
+ * back on its own is kept on a free list and handed out again.
+ * Every node is named by a 32-bit index instead of a 64-bit pointer.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * A chunked arena for objects of type T.
+ * Chunk i holds (FIRST_CHUNK << i) objects, so the number of chunks stays
+ * logarithmic in the number of objects and the chunk table never grows.
+ * Objects never move once allocated.
+ * Indices start at 1, so index 0 can be used as the null index.
+ * T must be trivially destructible: objects are never destroyed one by one.
+ */
+template <typename T>
+class NodeArena {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "NodeArena only holds trivially destructible objects");
+
+  public:
+    // log2 of the number of objects in the first chunk
+    static const unsigned int FIRST_CHUNK_BITS = 10;
+    // number of objects in the first chunk
+    static const size_t FIRST_CHUNK = size_t(1) << FIRST_CHUNK_BITS;
+    // max number of chunks, enough for almost 2^32 objects
+    static const unsigned int MAX_CHUNKS = 32 - FIRST_CHUNK_BITS;
+
+    /* It is the constructor. No memory is taken until the first allocate */
+    NodeArena() : numChunks(0), used(0), total(0) {}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /* Construct a new object, in the place of a released one if there is
+        one, else at the bump pointer.
+        arguments: the arguments forwarded to T's constructor
+        return: the index of the new object, never 0
+     */
+    template <typename... Args>
+    uint32_t allocate(Args&&... args) {
+        if (!freeList.empty()) {
+            // reuse the object released last
+            uint32_t index = freeList.back();
+            freeList.pop_back();
+            new (&(*this)[index]) T(std::forward<Args>(args)...);
+            return index;
+        }
+        return bump(std::forward<Args>(args)...);
+    }
+
+    /* Construct count objects with consecutive indices, so that they can be
+        filled in later, possibly by several threads at once. Released
+        objects are not reused here.
+        arguments: the number of objects, the arguments forwarded to each
+        T's constructor
+        return: the index of the first object
+     */
+    template <typename... Args>
+    uint32_t allocateRange(size_t count, const Args&... args) {
+        uint32_t first = (uint32_t)total + 1;
+        for (size_t i = 0; i < count; i++) {
+            bump(args...);
+        }
+        return first;
+    }
+
+    /* Give an object back, for allocate to hand out again. Its memory
+        stays in place until then, and the caller must not use the index
+        any more.
+     */
+    void release(uint32_t index) { freeList.push_back(index); }
+
+    /* return: the object with the given (non-zero) index */
+    T& operator[](uint32_t index) {
+        size_t slot = (size_t)index - 1 + FIRST_CHUNK;
+        unsigned int chunk = highestBit(slot) - FIRST_CHUNK_BITS;
+        return chunks[chunk][slot - (FIRST_CHUNK << chunk)];
+    }
+
+    /* return: the object with the given (non-zero) index */
+    const T& operator[](uint32_t index) const {
+        return const_cast<NodeArena&>(*this)[index];
+    }
+
+    /* Release every chunk at once. Objects are not visited. */
+    void clear() {
+        for (unsigned int i = 0; i < numChunks; i++) {
+            ::operator delete(chunks[i]);
+        }
+        numChunks = 0;
+        used = 0;
+        total = 0;
+        freeList.clear();
+    }
+
+    /* return: the number of objects in use */
+    size_t size() const { return total - freeList.size(); }
+
+    /* return: the largest index handed out so far, released or not */
+    size_t maxIndex() const { return total; }
+
+    /* return: the number of bytes reserved by the chunks */
+    size_t bytesReserved() const {
+        return ((FIRST_CHUNK << numChunks) - FIRST_CHUNK) * sizeof(T);
+    }
+
+    /* This is the destructor */
+    ~NodeArena() { clear(); }
+
+  private:
+    T* chunks[MAX_CHUNKS];
+    // number of chunks in use
+    unsigned int numChunks;
+    // number of objects used in the last chunk
+    size_t used;
+    // number of objects allocated in all chunks
+    size_t total;
+    // the indices of the released objects
+    std::vector<uint32_t> freeList;
+
+    /* return: the capacity of the i-th chunk */
+    static size_t chunkSize(unsigned int i) { return FIRST_CHUNK << i; }
+
+    /* return: the position of the highest set bit of a non-zero value */
+    static unsigned int highestBit(size_t value) {
+#if defined(__GNUC__)
+        return (unsigned int)(sizeof(unsigned long long) * 8 - 1 -
+                              __builtin_clzll(value));
+#else
+        unsigned int bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    /* Construct a new object at the bump pointer, past every object
+        allocated so far.
+        return: its index
+     */
+    template <typename... Args>
+    uint32_t bump(Args&&... args) {
+        if (numChunks == 0 || used == chunkSize(numChunks - 1)) {
+            grow();
+        }
+        new (chunks[numChunks - 1] + used) T(std::forward<Args>(args)...);
+        used++;
+        total++;
+        return (uint32_t)total;
+    }
+
+    /* Open a new chunk twice as large as the previous one */
+    void grow() {
+        if (numChunks == MAX_CHUNKS) {
+            throw std::bad_alloc();
+        }
+        chunks[numChunks] = static_cast<T*>(
+            ::operator new(chunkSize(numChunks) * sizeof(T)));
+        numChunks++;
+        used = 0;
+    }
+};
+
+#endif  // NODE_ARENA_HPP
@@ -0,0 +1,134 @@
+/**
+ * This File shows the implementation details of
+ * PatternAutomaton class methods, which are declared
+ * in "PatternAutomaton.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "PatternAutomaton.hpp"
+#include <algorithm>
+#include <bitset>
+#include <climits>
+
+/* It is the constructor. The automaton matches only the empty word until
+    a pattern is compiled
+ */
+PatternAutomaton::PatternAutomaton() { clear(); }
+
+/* Compile a pattern.
+    return: false if the pattern is malformed, in which case the automaton
+    matches nothing
+ */
+bool PatternAutomaton::compile(const string& pattern) {
+    clear();
+    unsigned int items = 0;
+    bool valid = true;
+    for (size_t i = 0; i < pattern.length(); i++) {
+        if (pattern[i] == '?') {
+            // a ? needs an item before it
+            valid = items > 0;
+            if (!valid) {
+                break;
+            }
+            skips |= uint64_t(1) << (items - 1);
+            continue;
+        }
+        if (items == MAX_ITEMS) {
+            valid = false;
+            break;
+        }
+
+        // the letters matched by the item
+        bitset<256> letters;
+        uint64_t item = uint64_t(1) << items;
+        if (pattern[i] == '\\') {
+            if (++i == pattern.length()) {
+                // nothing left to escape
+                valid = false;
+                break;
+            }
+            letters.set((unsigned char)pattern[i]);
+        } else if (pattern[i] == '_') {
+            letters.set();
+        } else if (pattern[i] == '*') {
+            letters.set();
+            loops |= item;
+            skips |= item;
+        } else if (pattern[i] == '[') {
+            bool negated = i + 1 < pattern.length() && pattern[i + 1] == '^';
+            i += negated ? 2 : 1;
+            for (; i < pattern.length() && pattern[i] != ']'; i++) {
+                if (pattern[i] == '\\' && i + 1 < pattern.length()) {
+                    i++;
+                }
+                unsigned char from = pattern[i];
+                unsigned char to = from;
+                if (i + 2 < pattern.length() && pattern[i + 1] == '-' &&
+                    pattern[i + 2] != ']') {
+                    to = pattern[i + 2];
+                    i += 2;
+                }
+                for (unsigned int c = from; c <= to; c++) {
+                    letters.set(c);
+                }
+            }
+            if (i == pattern.length()) {
+                // the class is never closed
+                valid = false;
+                break;
+            }
+            if (negated) {
+                letters.flip();
+            }
+        } else {
+            letters.set((unsigned char)pattern[i]);
+        }
+
+        low[items] = CHAR_MAX;
+        high[items] = CHAR_MIN;
+        for (int c = CHAR_MIN; c <= CHAR_MAX; c++) {
+            if (letters[(unsigned char)c]) {
+                masks[(unsigned char)c] |= item;
+                low[items] = min<char>(low[items], c);
+                high[items] = max<char>(high[items], c);
+            }
+        }
+        items++;
+    }
+    if (!valid) {
+        clear();
+        first = 0;
+        return false;
+    }
+    accept = uint64_t(1) << items;
+    first = close(1);
+    return true;
+}
+
+/* Find the range of the letters that can be read in the given states.
+    arguments: the states, the smallest and the largest such letter
+    return: false if no letter can be read
+ */
+bool PatternAutomaton::letterRange(uint64_t states, char& lowest,
+                                   char& highest) const {
+    lowest = CHAR_MAX;
+    highest = CHAR_MIN;
+    for (states &= ~accept; states != 0; states &= states - 1) {
+        unsigned int item = lowestBit(states);
+        lowest = min(lowest, low[item]);
+        highest = max(highest, high[item]);
+    }
+    return lowest <= highest;
+}
+
+/* Drop the pattern. The automaton matches only the empty word */
+void PatternAutomaton::clear() {
+    for (uint64_t& mask : masks) {
+        mask = 0;
+    }
+    loops = 0;
+    skips = 0;
+    first = 1;
+    accept = 1;
+}
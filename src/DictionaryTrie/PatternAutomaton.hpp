@@ -0,0 +1,114 @@
+/**
+ * This file declares PatternAutomaton, which compiles a small pattern
+ * language into an automaton that can be run one letter at a time.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef PATTERN_AUTOMATON_HPP
+#define PATTERN_AUTOMATON_HPP
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/**
+ * A pattern is a sequence of items, each matching one letter:
+ *   c       the letter c itself
+ *   _       any letter
+ *   [abc]   any of the letters listed, with ranges like [a-z], or any
+ *           other letter with [^...]
+ *   *       any run of letters, possibly empty
+ * and an item followed by ? may also be left out. A backslash makes the
+ * next character a plain letter, so \_ \* \[ \? and \\ match themselves.
+ *
+ * The items become the positions of a nondeterministic automaton, whose
+ * set of states is a 64-bit mask: bit i is set when the first i items
+ * have matched the letters read so far. A letter moves every state at
+ * once with a few bit operations (shift-and), so the automaton can follow
+ * a trie walk in lockstep, one state set per trie node.
+ */
+class PatternAutomaton {
+  public:
+    // the most items a pattern may have
+    static const unsigned int MAX_ITEMS = 63;
+
+    /* It is the constructor. The automaton matches only the empty word
+        until a pattern is compiled
+     */
+    PatternAutomaton();
+
+    /* Compile a pattern.
+        return: false if the pattern is malformed (an unclosed [, a ? with
+        nothing before it, a trailing backslash, or more than MAX_ITEMS
+        items), in which case the automaton matches nothing
+     */
+    bool compile(const string& pattern);
+
+    /* return: the states before reading any letter */
+    uint64_t start() const { return first; }
+
+    /* return: the states after reading a letter in the given states,
+        0 if the letters read so far cannot begin a match
+     */
+    uint64_t step(uint64_t states, char letter) const {
+        uint64_t moved = states & masks[(unsigned char)letter];
+        return close(((moved & ~loops) << 1) | (moved & loops));
+    }
+
+    /* return: true if the letters read so far match the whole pattern */
+    bool accepts(uint64_t states) const { return (states & accept) != 0; }
+
+    /* return: true if some letter can be read in the given states */
+    bool alive(uint64_t states) const { return (states & ~accept) != 0; }
+
+    /* Find the range of the letters that can be read in the given states.
+        arguments: the states, the smallest and the largest such letter,
+        in the order the trie compares letters
+        return: false if no letter can be read
+     */
+    bool letterRange(uint64_t states, char& lowest, char& highest) const;
+
+    /* Drop the pattern. The automaton matches only the empty word */
+    void clear();
+
+  private:
+    // bit i is set in masks[c] if item i matches the letter c
+    uint64_t masks[256];
+    // the items that may match many letters (*), or none (* and ?)
+    uint64_t loops;
+    uint64_t skips;
+    // the states before any letter, and the one after the last item
+    uint64_t first;
+    uint64_t accept;
+    // the smallest and the largest letter matched by each item
+    char low[MAX_ITEMS];
+    char high[MAX_ITEMS];
+
+    /* return: the position of the lowest set bit of a non-zero value */
+    static unsigned int lowestBit(uint64_t value) {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_ctzll(value);
+#else
+        unsigned int bit = 0;
+        while ((value & 1) == 0) {
+            value >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    /* return: the states, with the items that may be skipped skipped */
+    uint64_t close(uint64_t states) const {
+        uint64_t next = states | ((states & skips) << 1);
+        while (next != states) {
+            states = next;
+            next = states | ((states & skips) << 1);
+        }
+        return states;
+    }
+};
+
+#endif  // PATTERN_AUTOMATON_HPP
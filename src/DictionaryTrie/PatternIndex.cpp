@@ -0,0 +1,180 @@
+/**
+ * This File shows the implementation details of
+ * PatternIndex class methods, which are declared
+ * in "PatternIndex.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "PatternIndex.hpp"
+#include <algorithm>
+#include <utility>
+
+/* It is the constructor. The index starts empty */
+PatternIndex::PatternIndex() {}
+
+/* Index every word of the pool that is not erased, dropping what was
+    indexed before
+ */
+void PatternIndex::build(const WordPool& words) {
+    clear();
+    for (uint32_t id = 1; id <= words.size(); id++) {
+        if (words.erased(id)) {
+            continue;
+        }
+        size_t length = words.text(id).length();
+        if (length >= buckets.size()) {
+            buckets.resize(length + 1);
+        }
+        buckets[length].words.push_back(id);
+    }
+
+    for (size_t length = 1; length < buckets.size(); length++) {
+        Bucket& bucket = buckets[length];
+        if (bucket.words.empty()) {
+            continue;
+        }
+        // rank the words in the order of the completions
+        sort(bucket.words.begin(), bucket.words.end(),
+             [&words](uint32_t id1, uint32_t id2) {
+                 if (words.freq(id1) != words.freq(id2)) {
+                     return words.freq(id1) > words.freq(id2);
+                 }
+                 return words.text(id1) < words.text(id2);
+             });
+
+        // count the words of every position and letter, then lay the
+        // lists out back to back. Adding the ranks in increasing order
+        // keeps every list sorted.
+        bucket.offsets.assign(length * 256 + 1, 0);
+        for (uint32_t id : bucket.words) {
+            string_view text = words.text(id);
+            for (size_t i = 0; i < length; i++) {
+                bucket.offsets[i * 256 + (unsigned char)text[i] + 1]++;
+            }
+        }
+        for (size_t i = 1; i < bucket.offsets.size(); i++) {
+            bucket.offsets[i] += bucket.offsets[i - 1];
+        }
+        bucket.postings.resize(bucket.offsets.back());
+        vector<uint32_t> next(bucket.offsets.begin(), bucket.offsets.end() - 1);
+        for (uint32_t rank = 0; rank < bucket.words.size(); rank++) {
+            string_view text = words.text(bucket.words[rank]);
+            for (size_t i = 0; i < length; i++) {
+                bucket.postings[next[i * 256 + (unsigned char)text[i]]++] =
+                    rank;
+            }
+        }
+    }
+}
+
+/* Drop the index */
+void PatternIndex::clear() {
+    buckets.clear();
+    buckets.shrink_to_fit();
+}
+
+/* Find the best words matching a pattern, where '_' matches any letter.
+    arguments: the pattern, number of words, the list of word ids, best
+    first
+ */
+void PatternIndex::match(const string& pattern, unsigned int numCompletions,
+                         vector<uint32_t>& ids) const {
+    ids.clear();
+    const Bucket* bucket = bucketOf(pattern);
+    if (bucket == nullptr || numCompletions == 0) {
+        return;
+    }
+
+    // the posting lists of the fixed letters, [first, last) each. Every
+    // thread keeps its own, so a query in steady state allocates nothing.
+    static thread_local vector<pair<const uint32_t*, const uint32_t*>> lists;
+    lists.clear();
+    const uint32_t* postings = bucket->postings.data();
+    for (size_t i = 0; i < pattern.length(); i++) {
+        if (pattern[i] != '_') {
+            size_t list = i * 256 + (unsigned char)pattern[i];
+            if (bucket->offsets[list] == bucket->offsets[list + 1]) {
+                // no word has this letter here
+                return;
+            }
+            lists.push_back({postings + bucket->offsets[list],
+                             postings + bucket->offsets[list + 1]});
+        }
+    }
+    if (lists.empty()) {
+        // every word of the length matches, and they are in rank order
+        size_t count = min<size_t>(numCompletions, bucket->words.size());
+        ids.assign(bucket->words.begin(), bucket->words.begin() + count);
+        return;
+    }
+
+    // walk the shortest list, and leap every list to the rank it is at
+    // until they all agree on one
+    sort(lists.begin(), lists.end(),
+         [](const pair<const uint32_t*, const uint32_t*>& l1,
+            const pair<const uint32_t*, const uint32_t*>& l2) {
+             return l1.second - l1.first < l2.second - l2.first;
+         });
+    const uint32_t* lead = lists[0].first;
+    const uint32_t* leadEnd = lists[0].second;
+    while (lead != leadEnd && ids.size() < numCompletions) {
+        uint32_t rank = *lead;
+        bool agreed = true;
+        for (size_t j = 1; j < lists.size(); j++) {
+            const uint32_t*& first = lists[j].first;
+            first = gallop(first, lists[j].second, rank);
+            if (first == lists[j].second) {
+                // no rank left in this list, so no match left
+                return;
+            }
+            if (*first != rank) {
+                rank = *first;
+                agreed = false;
+                break;
+            }
+        }
+        if (agreed) {
+            ids.push_back(bucket->words[rank]);
+            lead++;
+        } else {
+            lead = gallop(lead, leadEnd, rank);
+        }
+    }
+}
+
+/* return: the number of bytes used by the index */
+size_t PatternIndex::memoryUsage() const {
+    size_t bytes = buckets.capacity() * sizeof(Bucket);
+    for (const Bucket& bucket : buckets) {
+        bytes += (bucket.words.capacity() + bucket.offsets.capacity() +
+                  bucket.postings.capacity()) *
+                 sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+/* return: the bucket of the pattern's length, or nullptr if no word has
+    that length
+ */
+const PatternIndex::Bucket* PatternIndex::bucketOf(
+    const string& pattern) const {
+    if (pattern.length() == 0 || pattern.length() >= buckets.size() ||
+        buckets[pattern.length()].words.empty()) {
+        return nullptr;
+    }
+    return &buckets[pattern.length()];
+}
+
+/* return: the first rank in [first, last) not less than rank, found by
+    doubling steps from first and then a binary search
+ */
+const uint32_t* PatternIndex::gallop(const uint32_t* first,
+                                     const uint32_t* last, uint32_t rank) {
+    size_t step = 1;
+    size_t size = last - first;
+    while (step < size && first[step] < rank) {
+        step *= 2;
+    }
+    return lower_bound(first + step / 2, first + min(step + 1, size), rank);
+}
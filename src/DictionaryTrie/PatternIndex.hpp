@@ -0,0 +1,79 @@
+/**
+ * This file declares PatternIndex, a positional inverted index of the words
+ * of a trie, for wildcard patterns of a fixed length.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef PATTERN_INDEX_HPP
+#define PATTERN_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WordPool.hpp"
+
+using namespace std;
+
+/**
+ * Buckets the words of a WordPool by length. Within a bucket, every word
+ * has a rank, in the order of the completions: the higher frequency first,
+ * then the word earlier in the alphabet. For every position and letter,
+ * the bucket keeps the posting list of the ranks of the words with that
+ * letter at that position, in increasing order.
+ * A pattern is matched by intersecting the lists of its fixed letters.
+ * Since the lists are in rank order, the matches come out best first and
+ * the intersection stops after k of them, however common the letters are.
+ * The index is a snapshot: words added to the pool later are not in it.
+ */
+class PatternIndex {
+  public:
+    /* It is the constructor. The index starts empty */
+    PatternIndex();
+
+    /* Index every word of the pool that is not erased, dropping what was
+        indexed before
+     */
+    void build(const WordPool& words);
+
+    /* Drop the index */
+    void clear();
+
+    /* Find the best words matching a pattern, where '_' matches any letter.
+        arguments: the pattern, number of words, the list of word ids,
+        best first
+     */
+    void match(const string& pattern, unsigned int numCompletions,
+               vector<uint32_t>& ids) const;
+
+    /* return: the number of bytes used by the index */
+    size_t memoryUsage() const;
+
+  private:
+    /** the words of one length */
+    struct Bucket {
+        // the word id of each rank
+        vector<uint32_t> words;
+        // the posting list of letter c at position i is
+        // postings[offsets[i * 256 + c], offsets[i * 256 + c + 1])
+        vector<uint32_t> offsets;
+        vector<uint32_t> postings;
+    };
+
+    // the bucket of each length, index 0 unused
+    vector<Bucket> buckets;
+
+    /* return: the bucket of the pattern's length, or nullptr if no word
+        has that length
+     */
+    const Bucket* bucketOf(const string& pattern) const;
+
+    /* return: the first rank in [first, last) not less than rank, found by
+        doubling steps from first and then a binary search
+     */
+    static const uint32_t* gallop(const uint32_t* first, const uint32_t* last,
+                                  uint32_t rank);
+};
+
+#endif  // PATTERN_INDEX_HPP
@@ -0,0 +1,498 @@
+/**
+ * This File shows the implementation details of
+ * RadixDictionaryTrie class methods, which are declared
+ * in "RadixDictionaryTrie.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "RadixDictionaryTrie.hpp"
+#include <algorithm>
+#include <cstring>
+
+/* It is the constructor of a node, with no fragment yet */
+RadixDictionaryTrie::Node::Node()
+    : left(0),
+      mid(0),
+      right(0),
+      word(0),
+      maxFreq(0),
+      offset(0),
+      length(0),
+      head() {}
+
+/* It is the constructor */
+RadixDictionaryTrie::RadixDictionaryTrie() { root = 0; }
+
+/* Insert a word with its frequency into the trie.
+    arguments: the word, its frequency
+    return: true if the word was inserted, false if it is empty or already
+    in the trie
+ */
+bool RadixDictionaryTrie::insert(string_view word, unsigned int freq) {
+    if (word.length() == 0) {
+        return false;
+    }
+
+    // walk down to the link where the word leaves the trie, keeping every
+    // node visited for the maxFreq update
+    uint32_t* link = &root;
+    size_t i = 0;
+    insertPath.clear();
+    while (*link != 0) {
+        uint32_t ptr = *link;
+        Node& node = nodes[ptr];
+        insertPath.push_back(ptr);
+        if (word[i] < node.head[0]) {
+            link = &node.left;
+            continue;
+        }
+        if (word[i] > node.head[0]) {
+            link = &node.right;
+            continue;
+        }
+
+        // the first letters agree, so find how much of the fragment the
+        // word follows, and split the fragment where they part
+        size_t length = min<size_t>(node.length, word.length() - i);
+        const char* letter = fragment(node);
+        size_t matched =
+            mismatch(letter, letter + length, word.data() + i).first - letter;
+        if (matched < node.length) {
+            split(ptr, matched);
+        }
+        i += matched;
+        if (i == word.length()) {
+            if (node.word != 0) {
+                // the word is already in the trie
+                return false;
+            }
+            node.word = words.add(word, freq);
+            raiseMaxFreq(freq);
+            return true;
+        }
+        link = &node.mid;
+    }
+
+    uint32_t id = words.add(word, freq);
+    *link = addChain(word.substr(i), id, freq);
+    raiseMaxFreq(freq);
+    return true;
+}
+
+/* return: true if word e1 comes before e2 in the trie, comparing their
+    letters the same way the descent loops do
+ */
+static bool lessByLetters(const pair<string_view, unsigned int>& e1,
+                          const pair<string_view, unsigned int>& e2) {
+    return lexicographical_compare(e1.first.begin(), e1.first.end(),
+                                   e2.first.begin(), e2.first.end());
+}
+
+/* Build a balanced trie from a whole set of words at once.
+    arguments: pairs of word and frequency, best sorted alphabetically
+ */
+void RadixDictionaryTrie::buildFromSorted(const EntryList& entries) {
+    if (root != 0) {
+        // fall back to the incremental path on a populated trie
+        for (const pair<string_view, unsigned int>& e : entries) {
+            insert(e.first, e.second);
+        }
+        return;
+    }
+
+    // sorted without empty words and with the first of equal words only
+    EntryList sorted(entries);
+    if (!is_sorted(sorted.begin(), sorted.end(), lessByLetters)) {
+        stable_sort(sorted.begin(), sorted.end(), lessByLetters);
+    }
+    sorted.erase(remove_if(sorted.begin(), sorted.end(),
+                           [](const pair<string_view, unsigned int>& e) {
+                               return e.first.length() == 0;
+                           }),
+                 sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end(),
+                        [](const pair<string_view, unsigned int>& e1,
+                           const pair<string_view, unsigned int>& e2) {
+                            return e1.first == e2.first;
+                        }),
+                 sorted.end());
+    if (sorted.empty()) {
+        return;
+    }
+
+    // the words get their ids in order, so entry i has firstWord + i
+    uint32_t firstWord = (uint32_t)words.size() + 1;
+    for (const pair<string_view, unsigned int>& e : sorted) {
+        words.add(e.first, e.second);
+    }
+    root = buildLevel(sorted, 0, sorted.size(), 0, firstWord);
+}
+
+/* This is the function to find whether the word is in the trie.
+    arguments: the target word
+    return true if the word is found, false otherwise
+ */
+bool RadixDictionaryTrie::find(const string& word) const {
+    uint32_t ptr = root;
+    size_t i = 0;
+    while (ptr != 0 && i < word.length()) {
+        const Node& node = nodes[ptr];
+        if (word[i] < node.head[0]) {
+            ptr = node.left;
+        } else if (word[i] > node.head[0]) {
+            ptr = node.right;
+        } else {
+            // the whole fragment must follow. Most fragments are a single
+            // letter, already compared.
+            if (node.length > 1 &&
+                (word.length() - i < node.length ||
+                 memcmp(fragment(node) + 1, word.data() + i + 1,
+                        node.length - 1) != 0)) {
+                return false;
+            }
+            i += node.length;
+            if (i == word.length()) {
+                return node.word != 0;
+            }
+            ptr = node.mid;
+        }
+    }
+    return false;
+}
+
+/* Use frequency to complete the predict completions.
+    arguments: prefix, number of completions return.
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> RadixDictionaryTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    if (numCompletions == 0) {
+        return drain(heap);
+    }
+    if (prefix.length() == 0) {
+        collect(root, numCompletions, heap);
+        return drain(heap);
+    }
+
+    uint32_t ptr = root;
+    size_t i = 0;
+    while (ptr != 0) {
+        const Node& node = nodes[ptr];
+        if (prefix[i] < node.head[0]) {
+            ptr = node.left;
+        } else if (prefix[i] > node.head[0]) {
+            ptr = node.right;
+        } else {
+            // the prefix may end inside the fragment
+            size_t length = min<size_t>(node.length, prefix.length() - i);
+            if (memcmp(fragment(node) + 1, prefix.data() + i + 1,
+                       length - 1) != 0) {
+                break;
+            }
+            i += length;
+            if (i == prefix.length()) {
+                // every word of the node and below it completes the prefix
+                if (node.word != 0) {
+                    offerWord(node.word, numCompletions, heap);
+                }
+                collect(node.mid, numCompletions, heap);
+                break;
+            }
+            ptr = node.mid;
+        }
+    }
+    return drain(heap);
+}
+
+/* function for wildcard prediction
+    arguments: pattern with (or without) underscore(s)
+                number of completions desired
+    return: a list of completions, sorted by their frequency
+ */
+vector<string> RadixDictionaryTrie::predictUnderscores(
+    const string& pattern, unsigned int numCompletions) const {
+    vector<uint32_t> heap;
+    if (pattern.length() > 0 && numCompletions > 0) {
+        matchPattern(root, pattern, 0, numCompletions, heap);
+    }
+    return drain(heap);
+}
+
+/* return: the number of nodes in the trie */
+size_t RadixDictionaryTrie::nodeCount() const { return nodes.size(); }
+
+/* return: the number of bytes reserved for the nodes, the fragments and
+    the words
+ */
+size_t RadixDictionaryTrie::memoryUsage() const {
+    return nodes.bytesReserved() + letters.capacity() + words.memoryUsage();
+}
+
+/* helper method for buildFromSorted. Builds the sibling chain for the
+    letters at position depth of the sorted entries in [lo, hi).
+    return: the root of the chain
+ */
+uint32_t RadixDictionaryTrie::buildLevel(const EntryList& entries, size_t lo,
+                                         size_t hi, size_t depth,
+                                         uint32_t firstWord) {
+    if (lo == hi) {
+        return 0;
+    }
+    // split the entries into groups by their letter at depth
+    vector<size_t> groups;
+    for (size_t i = lo; i < hi; i++) {
+        if (i == lo || entries[i].first[depth] != entries[i - 1].first[depth]) {
+            groups.push_back(i);
+        }
+    }
+    groups.push_back(hi);
+    return buildSiblings(entries, groups, 0, groups.size() - 1, depth,
+                         firstWord);
+}
+
+/* helper method for buildLevel. Builds a balanced chain from the letter
+    groups [gLo, gHi) and computes maxFreq bottom-up. Each node is placed
+    before its mid subtree, which is placed before the left and right ones.
+    return: the root of the chain
+ */
+uint32_t RadixDictionaryTrie::buildSiblings(const EntryList& entries,
+                                            const vector<size_t>& groups,
+                                            size_t gLo, size_t gHi,
+                                            size_t depth, uint32_t firstWord) {
+    if (gLo == gHi) {
+        return 0;
+    }
+    // the median letter becomes the root of the chain
+    size_t g = gLo + (gHi - gLo) / 2;
+    size_t lo = groups[g];
+    size_t hi = groups[g + 1];
+    uint32_t ptr = nodes.allocate();
+    Node& node = nodes[ptr];
+
+    // the words of the group are sorted, so they all agree as far as the
+    // first and the last agree, and only the first can end before that
+    string_view first = entries[lo].first;
+    string_view last = entries[hi - 1].first;
+    size_t end = depth + 1;
+    size_t limit =
+        min(min(first.length(), last.length()), depth + MAX_FRAGMENT);
+    while (end < limit && first[end] == last[end]) {
+        end++;
+    }
+    setFragment(node, first.substr(depth, end - depth));
+    unsigned int maxFreq = 0;
+    if (first.length() == end) {
+        node.word = firstWord + (uint32_t)lo;
+        maxFreq = entries[lo].second;
+        lo++;
+    }
+    node.mid = buildLevel(entries, lo, hi, end, firstWord);
+    node.left = buildSiblings(entries, groups, gLo, g, depth, firstWord);
+    node.right = buildSiblings(entries, groups, g + 1, gHi, depth, firstWord);
+    for (uint32_t p : {node.left, node.mid, node.right}) {
+        if (p != 0) {
+            maxFreq = max(maxFreq, nodes[p].maxFreq);
+        }
+    }
+    node.maxFreq = maxFreq;
+    return ptr;
+}
+
+/* Store text as the fragment of a node. Only a text longer than the node
+    holds itself goes to the letters.
+ */
+void RadixDictionaryTrie::setFragment(Node& node, string_view text) {
+    node.length = (uint16_t)text.length();
+    memcpy(node.head, text.data(), min<size_t>(text.length(), HEAD));
+    if (text.length() > HEAD) {
+        node.offset = (uint32_t)letters.size();
+        letters.insert(letters.end(), text.begin(), text.end());
+    }
+}
+
+/* Append a chain of nodes spelling text, with the word at its end. A text
+    longer than a fragment takes several nodes.
+    arguments: the text, the id and frequency of the word
+    return: the first node of the chain
+ */
+uint32_t RadixDictionaryTrie::addChain(string_view text, uint32_t id,
+                                       unsigned int freq) {
+    uint32_t head = 0;
+    uint32_t* link = &head;
+    for (size_t i = 0; i < text.length(); i += MAX_FRAGMENT) {
+        uint32_t ptr = nodes.allocate();
+        Node& node = nodes[ptr];
+        setFragment(node, text.substr(i, MAX_FRAGMENT));
+        node.maxFreq = freq;
+        *link = ptr;
+        link = &node.mid;
+        if (i + node.length == text.length()) {
+            node.word = id;
+        }
+    }
+    return head;
+}
+
+/* Split a node after the first length letters of its fragment. The rest
+    becomes its mid child, with the node's word and mid subtree.
+ */
+void RadixDictionaryTrie::split(uint32_t ptr, size_t length) {
+    uint32_t rest = nodes.allocate();
+    Node& node = nodes[ptr];
+    Node& tail = nodes[rest];
+    // the tail is long only if the node was, so it can share its letters
+    tail.offset = node.offset + (uint32_t)length;
+    tail.length = (uint16_t)(node.length - length);
+    memcpy(tail.head, fragment(node) + length,
+           min<size_t>(tail.length, HEAD));
+    tail.word = node.word;
+    tail.mid = node.mid;
+    tail.maxFreq = node.word != 0 ? words.freq(node.word) : 0;
+    if (node.mid != 0) {
+        tail.maxFreq = max(tail.maxFreq, nodes[node.mid].maxFreq);
+    }
+    node.length = (uint16_t)length;
+    node.word = 0;
+    node.mid = rest;
+}
+
+/* helper method for insert. Raises the maxFreq of the nodes in insertPath
+    to freq where it is lower. A node's maxFreq is never below the ones
+    under it, so the walk back up stops at the first node high enough.
+ */
+void RadixDictionaryTrie::raiseMaxFreq(unsigned int freq) {
+    while (!insertPath.empty()) {
+        Node& node = nodes[insertPath.back()];
+        if (freq <= node.maxFreq) {
+            break;
+        }
+        node.maxFreq = freq;
+        insertPath.pop_back();
+    }
+}
+
+/* return: true if the fragment matches the pattern, where '_' matches any
+    letter. The runs between underscores are compared with memcmp.
+    arguments: the fragment, the pattern, their length
+ */
+bool RadixDictionaryTrie::fragmentMatches(const char* letters,
+                                          const char* pattern, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        const char* blank =
+            static_cast<const char*>(memchr(pattern + i, '_', length - i));
+        size_t run = (blank == nullptr ? length : blank - pattern) - i;
+        if (memcmp(letters + i, pattern + i, run) != 0) {
+            return false;
+        }
+        i += run + 1;
+    }
+    return true;
+}
+
+/* return: true if word id1 comes before id2 in the completions: the
+    higher frequency first, then the word earlier in the alphabet
+ */
+bool RadixDictionaryTrie::betterWord(uint32_t id1, uint32_t id2) const {
+    unsigned int freq1 = words.freq(id1);
+    unsigned int freq2 = words.freq(id2);
+    if (freq1 != freq2) {
+        return freq1 > freq2;
+    }
+    return words.text(id1) < words.text(id2);
+}
+
+/* Offer a word to a heap of the best k words, the worst on top */
+void RadixDictionaryTrie::offerWord(uint32_t id, unsigned int k,
+                                    vector<uint32_t>& heap) const {
+    auto better = [this](uint32_t id1, uint32_t id2) {
+        return betterWord(id1, id2);
+    };
+    if (heap.size() < k) {
+        heap.push_back(id);
+        push_heap(heap.begin(), heap.end(), better);
+    } else if (betterWord(id, heap.front())) {
+        pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = id;
+        push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+/* return: true if no word under a node with this maxFreq can enter a full
+    heap of the best k words
+ */
+bool RadixDictionaryTrie::prunes(unsigned int maxFreq, unsigned int k,
+                                 const vector<uint32_t>& heap) const {
+    return heap.size() == k && maxFreq < words.freq(heap.front());
+}
+
+/* Turn a heap into the list of completions, best first */
+vector<string> RadixDictionaryTrie::drain(vector<uint32_t>& heap) const {
+    sort(heap.begin(), heap.end(), [this](uint32_t id1, uint32_t id2) {
+        return betterWord(id1, id2);
+    });
+    vector<string> results;
+    results.reserve(heap.size());
+    for (uint32_t id : heap) {
+        results.push_back(string(words.text(id)));
+    }
+    return results;
+}
+
+/* depth first top-k search of the subtree rooted at ptr, pruned by maxFreq
+ */
+void RadixDictionaryTrie::collect(uint32_t ptr, unsigned int k,
+                                  vector<uint32_t>& heap) const {
+    if (ptr == 0) {
+        return;
+    }
+    const Node& node = nodes[ptr];
+    if (prunes(node.maxFreq, k, heap)) {
+        return;
+    }
+    if (node.word != 0) {
+        offerWord(node.word, k, heap);
+    }
+    collect(node.mid, k, heap);
+    collect(node.left, k, heap);
+    collect(node.right, k, heap);
+}
+
+/* match pattern[pos..] against the subtree rooted at ptr */
+void RadixDictionaryTrie::matchPattern(uint32_t ptr, const string& pattern,
+                                       size_t pos, unsigned int k,
+                                       vector<uint32_t>& heap) const {
+    if (ptr == 0) {
+        return;
+    }
+    const Node& node = nodes[ptr];
+    if (prunes(node.maxFreq, k, heap)) {
+        return;
+    }
+    char letter = pattern[pos];
+    bool blank = letter == '_';
+    if (blank || letter < node.head[0]) {
+        matchPattern(node.left, pattern, pos, k, heap);
+    }
+    if (blank || letter > node.head[0]) {
+        matchPattern(node.right, pattern, pos, k, heap);
+    }
+    if (blank || letter == node.head[0]) {
+        // the rest of the fragment must fit in the pattern and match it
+        size_t end = pos + node.length;
+        if (end > pattern.length() ||
+            !fragmentMatches(fragment(node) + 1, pattern.data() + pos + 1,
+                             node.length - 1)) {
+            return;
+        }
+        if (end == pattern.length()) {
+            if (node.word != 0) {
+                offerWord(node.word, k, heap);
+            }
+        } else {
+            matchPattern(node.mid, pattern, end, k, heap);
+        }
+    }
+}
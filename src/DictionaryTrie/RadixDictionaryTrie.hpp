@@ -0,0 +1,212 @@
+/**
+ * This file declares the structure of RadixDictionaryTrie class, a ternary
+ * search tree whose chains of single mid children are merged into one
+ * node each.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef RADIX_DICTIONARY_TRIE_HPP
+#define RADIX_DICTIONARY_TRIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "NodeArena.hpp"
+#include "WordPool.hpp"
+
+using namespace std;
+
+/**
+ * A path-compressed (radix) ternary search tree, another engine behind the
+ * same insert, find and predict interface as DictionaryTrie.
+ * A node holds a fragment of letters instead of one letter. Its first
+ * letter is compared with the siblings as in the TST, and the rest are a
+ * run of letters where no word ends and nothing branches, which the TST
+ * would spell out as a chain of single mid children. The long tails of
+ * rare words and phrases therefore take one node each, and a descent
+ * compares them with one memcmp. Short fragments are kept in the node
+ * itself, so only the long ones cost a read elsewhere. An insert that
+ * leaves a fragment halfway splits it in two.
+ * Every node keeps the largest frequency of its subtree (with left and
+ * right), which prunes the top-k searches as in DictionaryTrie.
+ * The trie is for one thread at a time.
+ */
+class RadixDictionaryTrie {
+  private:
+    /** a node of the radix TST */
+    struct Node {
+        // index of the children, 0 if absent
+        uint32_t left;
+        uint32_t mid;
+        uint32_t right;
+        // the id of the word ending after the fragment, 0 if none
+        uint32_t word;
+        unsigned int maxFreq;
+        // a fragment longer than HEAD letters is letters[offset, offset +
+        // length), a shorter one sits in head alone
+        uint32_t offset;
+        uint16_t length;
+        // the first letters of the fragment. head[0] is the one compared
+        // with the siblings.
+        char head[6];
+
+        Node();
+    };
+
+    // the most letters a node holds itself, which fills it up to 32 bytes
+    static constexpr size_t HEAD = sizeof(Node::head);
+    // the longest fragment a node can hold
+    static constexpr size_t MAX_FRAGMENT = 0xffff;
+
+    // index of the root of the trie, or 0 if empty trie
+    uint32_t root;
+
+    // owns every node of the trie
+    NodeArena<Node> nodes;
+
+    // the letters of the fragments longer than HEAD. A split shares them
+    // between the two halves, so they are only ever appended.
+    vector<char> letters;
+
+    // the id, text and frequency of every word
+    WordPool words;
+
+    // scratch stack of the nodes visited by insert
+    vector<uint32_t> insertPath;
+
+  public:
+    /* It is the constructor */
+    RadixDictionaryTrie();
+
+    RadixDictionaryTrie(const RadixDictionaryTrie&) = delete;
+    RadixDictionaryTrie& operator=(const RadixDictionaryTrie&) = delete;
+
+    /* Insert a word with its frequency into the trie.
+        arguments: the word, its frequency
+        return: true if the word was inserted, false if it is empty or
+        already in the trie
+     */
+    bool insert(string_view word, unsigned int freq);
+
+    /* Build a balanced trie from a whole set of words at once. The median
+        letter of every sibling chain is its root, every fragment runs as
+        far as the words under it agree, and the nodes are laid out in the
+        order a descent meets them. On a trie that is not empty the words
+        are inserted one by one instead.
+        arguments: pairs of word and frequency, best sorted alphabetically
+     */
+    void buildFromSorted(
+        const vector<pair<string_view, unsigned int>>& entries);
+
+    /* This is the function to find whether the word is in the trie.
+        arguments: the target word
+        return true if the word is found, false otherwise
+     */
+    bool find(const string& word) const;
+
+    /* Use frequency to complete the predict completions.
+        arguments: prefix, number of completions return.
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* function for wildcard prediction
+        arguments: pattern with (or without) underscore(s)
+                    number of completions desired
+        return: a list of completions, sorted by their frequency
+     */
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const;
+
+    /* return: the number of nodes in the trie */
+    size_t nodeCount() const;
+
+    /* return: the number of bytes reserved for the nodes, the fragments
+        and the words
+     */
+    size_t memoryUsage() const;
+
+  private:
+    /* return: the letters of a node's fragment */
+    const char* fragment(const Node& node) const {
+        return node.length <= HEAD ? node.head : letters.data() + node.offset;
+    }
+
+    /* Store text as the fragment of a node */
+    void setFragment(Node& node, string_view text);
+
+    /* Append a chain of nodes spelling text, with the word at its end.
+        arguments: the text, the id and frequency of the word
+        return: the first node of the chain
+     */
+    uint32_t addChain(string_view text, uint32_t id, unsigned int freq);
+
+    /* Split a node after the first length letters of its fragment. The
+        rest becomes its mid child, with the node's word and mid subtree.
+     */
+    void split(uint32_t ptr, size_t length);
+
+    /** the words of a bulk build */
+    typedef vector<pair<string_view, unsigned int>> EntryList;
+
+    /* helper method for buildFromSorted. Builds the sibling chain for the
+        letters at position depth of the sorted entries in [lo, hi), whose
+        word ids start at firstWord.
+        return: the root of the chain
+     */
+    uint32_t buildLevel(const EntryList& entries, size_t lo, size_t hi,
+                        size_t depth, uint32_t firstWord);
+
+    /* helper method for buildLevel. Builds a balanced chain from the letter
+        groups [gLo, gHi), where group g covers entries [groups[g],
+        groups[g + 1]), and computes maxFreq bottom-up.
+        return: the root of the chain
+     */
+    uint32_t buildSiblings(const EntryList& entries,
+                           const vector<size_t>& groups, size_t gLo,
+                           size_t gHi, size_t depth, uint32_t firstWord);
+
+    /* helper method for insert. Raises the maxFreq of the nodes in
+        insertPath to freq where it is lower.
+     */
+    void raiseMaxFreq(unsigned int freq);
+
+    /* return: true if the fragment matches the pattern, where '_' matches
+        any letter
+        arguments: the fragment, the pattern, their length
+     */
+    static bool fragmentMatches(const char* letters, const char* pattern,
+                                size_t length);
+
+    /* return: true if word id1 comes before id2 in the completions: the
+        higher frequency first, then the word earlier in the alphabet
+     */
+    bool betterWord(uint32_t id1, uint32_t id2) const;
+
+    /* Offer a word to a heap of the best k words, the worst on top */
+    void offerWord(uint32_t id, unsigned int k, vector<uint32_t>& heap) const;
+
+    /* return: true if no word under a node with this maxFreq can enter a
+        full heap of the best k words
+     */
+    bool prunes(unsigned int maxFreq, unsigned int k,
+                const vector<uint32_t>& heap) const;
+
+    /* Turn a heap into the list of completions, best first */
+    vector<string> drain(vector<uint32_t>& heap) const;
+
+    /* depth first top-k search of the subtree rooted at ptr, pruned by
+        maxFreq
+     */
+    void collect(uint32_t ptr, unsigned int k, vector<uint32_t>& heap) const;
+
+    /* match pattern[pos..] against the subtree rooted at ptr */
+    void matchPattern(uint32_t ptr, const string& pattern, size_t pos,
+                      unsigned int k, vector<uint32_t>& heap) const;
+};
+
+#endif  // RADIX_DICTIONARY_TRIE_HPP
@@ -0,0 +1,82 @@
+/**
+ * This File shows the implementation details of
+ * WordPool class methods, which are declared
+ * in "WordPool.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "WordPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/* It is the constructor. No memory is taken until the first add */
+WordPool::WordPool()
+    : numErased(0), numChunks(0), used(0), capacity(0), reserved(0) {}
+
+/* Add a word to the pool.
+    arguments: the text of the word, its frequency
+    return: the id of the word, never 0
+ */
+uint32_t WordPool::add(string_view text, unsigned int freq) {
+    if (numChunks == 0 || capacity - used < text.length()) {
+        // a text never spans two chunks
+        grow(text.length());
+    }
+    char* copy = chunks[numChunks - 1] + used;
+    memcpy(copy, text.data(), text.length());
+    used += text.length();
+    return words.allocate(copy, (uint32_t)text.length(), freq);
+}
+
+/* Mark the word with the given (non-zero) id as erased */
+void WordPool::erase(uint32_t id) {
+    if (id >= retired.size()) {
+        retired.resize(words.size() + 1);
+    }
+    if (!retired[id]) {
+        retired[id] = true;
+        numErased++;
+    }
+}
+
+/* return: the number of bytes reserved for the records and texts */
+size_t WordPool::memoryUsage() const {
+    return words.bytesReserved() + reserved;
+}
+
+/* Drop every word at once */
+void WordPool::clear() {
+    words.clear();
+    retired.clear();
+    numErased = 0;
+    for (unsigned int i = 0; i < numChunks; i++) {
+        ::operator delete(chunks[i]);
+    }
+    numChunks = 0;
+    used = 0;
+    capacity = 0;
+    reserved = 0;
+}
+
+/* This is the destructor */
+WordPool::~WordPool() { clear(); }
+
+/* Open a new chunk twice as large as the previous one, or as large as a
+    text of the given length
+ */
+void WordPool::grow(size_t length) {
+    if (numChunks == MAX_CHUNKS) {
+        throw bad_alloc();
+    }
+    capacity = max(FIRST_CHUNK << numChunks, length);
+    chunks[numChunks] = static_cast<char*>(::operator new(capacity));
+    numChunks++;
+    used = 0;
+    reserved += capacity;
+}
+
+/* It is the constructor of a word record */
+WordPool::Word::Word(const char* text, uint32_t length, unsigned int freq)
+    : text(text), length(length), freq(freq) {}
@@ -0,0 +1,120 @@
+/**
+ * This file declares WordPool, which numbers the words of a trie and keeps
+ * their text and frequency.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef WORD_POOL_HPP
+#define WORD_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "NodeArena.hpp"
+
+using namespace std;
+
+/**
+ * Gives every word added to it a dense 32-bit id, starting at 1 so that 0
+ * can mean "no word", and stores its text once.
+ * The texts are appended back to back into large chunks, so a text is
+ * read in O(1) as a string_view into the pool, without building a string.
+ * Like the nodes of NodeArena, records and texts never move once added:
+ * one thread may add words while others read the ones they were given.
+ * An erased word keeps its record, and its id is never given again.
+ */
+class WordPool {
+  public:
+    // number of bytes of text in the first chunk
+    static const size_t FIRST_CHUNK = size_t(1) << 16;
+    // max number of text chunks, each twice as large as the one before
+    static const unsigned int MAX_CHUNKS = 40;
+
+    /* It is the constructor. No memory is taken until the first add */
+    WordPool();
+
+    WordPool(const WordPool&) = delete;
+    WordPool& operator=(const WordPool&) = delete;
+
+    /* Add a word to the pool.
+        arguments: the text of the word, its frequency
+        return: the id of the word, never 0
+     */
+    uint32_t add(string_view text, unsigned int freq);
+
+    /* return: the text of the word with the given (non-zero) id, which
+        stays valid as long as the pool
+     */
+    string_view text(uint32_t id) const {
+        const Word& word = words[id];
+        return string_view(word.text, word.length);
+    }
+
+    /* return: the frequency of the word with the given (non-zero) id */
+    unsigned int freq(uint32_t id) const { return words[id].freq; }
+
+    /* Change the frequency of the word with the given (non-zero) id */
+    void setFreq(uint32_t id, unsigned int freq) {
+        words[id].freq.store(freq, memory_order_release);
+    }
+
+    /* return: the number of words added so far, erased ones included */
+    size_t size() const { return words.size(); }
+
+    /* Mark the word with the given (non-zero) id as erased. Its text and
+        frequency stay readable.
+     */
+    void erase(uint32_t id);
+
+    /* return: true if the word with the given (non-zero) id was erased */
+    bool erased(uint32_t id) const {
+        return id < retired.size() && retired[id];
+    }
+
+    /* return: the number of words erased so far */
+    size_t erasedCount() const { return numErased; }
+
+    /* return: the number of bytes reserved for the records and texts */
+    size_t memoryUsage() const;
+
+    /* Drop every word at once */
+    void clear();
+
+    /* This is the destructor */
+    ~WordPool();
+
+  private:
+    /** the record of a word: where its text is, and its frequency */
+    struct Word {
+        const char* text;
+        uint32_t length;
+        atomic<unsigned int> freq;
+
+        Word(const char* text, uint32_t length, unsigned int freq);
+    };
+
+    // the records, indexed by id
+    NodeArena<Word> words;
+    // retired[id] is true if the word was erased, grown on demand
+    vector<bool> retired;
+    size_t numErased;
+
+    char* chunks[MAX_CHUNKS];
+    // number of chunks in use
+    unsigned int numChunks;
+    // number of bytes used and available in the last chunk
+    size_t used;
+    size_t capacity;
+    // number of bytes reserved by all chunks
+    size_t reserved;
+
+    /* Open a new chunk twice as large as the previous one, or as large as
+        a text of the given length
+     */
+    void grow(size_t length);
+};
+
+#endif  // WORD_POOL_HPP
@@ -0,0 +1,97 @@
+/**
+ * This File shows the implementation details of
+ * WorkPool class methods, which are declared
+ * in "WorkPool.hpp"
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include "WorkPool.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* Run task(0), ..., task(count - 1) and wait for all of them.
+    arguments: the number of tasks, the number of threads (the calling
+    thread is one of them), the task
+ */
+void WorkPool::run(size_t count, unsigned int numThreads,
+                   const function<void(size_t)>& task) {
+    if (numThreads > count) {
+        numThreads = count;
+    }
+    if (numThreads <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    unique_ptr<Share[]> shares(new Share[numThreads]);
+    for (unsigned int w = 0; w < numThreads; w++) {
+        shares[w].begin = count * w / numThreads;
+        shares[w].end = count * (w + 1) / numThreads;
+    }
+    vector<thread> threads;
+    for (unsigned int w = 1; w < numThreads; w++) {
+        threads.emplace_back(work, shares.get(), numThreads, w, cref(task));
+    }
+    work(shares.get(), numThreads, 0, task);
+    for (thread& t : threads) {
+        t.join();
+    }
+}
+
+/* Run the tasks of thread w, then steal until no task is left */
+void WorkPool::work(Share* shares, unsigned int numShares, unsigned int w,
+                    const function<void(size_t)>& task) {
+    Share& own = shares[w];
+    while (true) {
+        size_t i = 0;
+        bool taken = false;
+        {
+            lock_guard<mutex> guard(own.lock);
+            if (own.begin < own.end) {
+                i = own.begin++;
+                taken = true;
+            }
+        }
+        if (taken) {
+            task(i);
+            continue;
+        }
+
+        // find the largest share left and take its back half
+        unsigned int victim = w;
+        size_t largest = 0;
+        for (unsigned int v = 0; v < numShares; v++) {
+            if (v != w) {
+                lock_guard<mutex> guard(shares[v].lock);
+                size_t left = shares[v].end - shares[v].begin;
+                if (left > largest) {
+                    largest = left;
+                    victim = v;
+                }
+            }
+        }
+        if (victim == w) {
+            return;
+        }
+        size_t begin;
+        size_t end;
+        {
+            lock_guard<mutex> guard(shares[victim].lock);
+            end = shares[victim].end;
+            size_t left = end - shares[victim].begin;
+            if (left == 0) {
+                // taken meanwhile, look again
+                continue;
+            }
+            shares[victim].end -= (left + 1) / 2;
+            begin = shares[victim].end;
+        }
+        lock_guard<mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * This file declares WorkPool, which spreads independent tasks over a
+ * number of threads with work stealing.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu shzhou@ucsd.edu
+ */
+#ifndef WORK_POOL_HPP
+#define WORK_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+using namespace std;
+
+/**
+ * Runs the tasks 0, ..., count - 1 on a number of threads. Every thread
+ * starts with an equal share of consecutive tasks and takes them from the
+ * front. A thread that runs out steals the back half of the largest share
+ * left, so a few expensive tasks do not hold the others up.
+ */
+class WorkPool {
+  public:
+    /* Run task(0), ..., task(count - 1) and wait for all of them.
+        arguments: the number of tasks, the number of threads (the calling
+        thread is one of them), the task
+     */
+    static void run(size_t count, unsigned int numThreads,
+                    const function<void(size_t)>& task);
+
+  private:
+    /** the tasks [begin, end) not yet taken by a thread */
+    struct Share {
+        mutex lock;
+        size_t begin;
+        size_t end;
+    };
+
+    /* Run the tasks of thread w, then steal until no task is left */
+    static void work(Share* shares, unsigned int numShares, unsigned int w,
+                     const function<void(size_t)>& task);
+};
+
+#endif  // WORK_POOL_HPP
@@ -3,8 +3,14 @@
  * benchmarking DictionaryTrie
  */
 #include "util.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <thread>
 
 /* Starts the timer. Saves the current time. */
 void Timer::begin_timer() { start = std::chrono::high_resolution_clock::now(); }
@@ -21,93 +27,290 @@ long long Timer::end_timer() {
         .count();
 }
 
+// the size of the blocks read from the dictionary stream
+static const size_t BLOCK_SIZE = 1 << 20;
+
+/* whitespace as istream sees it, apart from the line break */
+static inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/* It is the constructor of DictReader */
+DictReader::DictReader(istream& in, bool wholeFile)
+    : in(&in),
+      buffer(BLOCK_SIZE),
+      data(buffer.data()),
+      pos(0),
+      len(0),
+      eof(false),
+      bytes(0) {
+    if (wholeFile) {
+        while (!eof) {
+            fill();
+        }
+    }
+}
+
+/* It is the constructor of DictReader for a range of memory */
+DictReader::DictReader(char* begin, char* end)
+    : in(nullptr),
+      data(begin),
+      pos(0),
+      len(end - begin),
+      eof(true),
+      bytes(end - begin) {}
+
+/* Read the next entry of the file. Lines without a frequency are skipped.
+ * Returns false at the end of the file
+ */
+bool DictReader::next(unsigned int& freq, string_view& word) {
+    while (true) {
+        char* start = data + pos;
+        char* newline = static_cast<char*>(memchr(start, '\n', len - pos));
+        char* lineEnd = newline;
+        if (newline == nullptr) {
+            if (!eof) {
+                fill();
+                continue;
+            }
+            if (pos == len) {
+                return false;
+            }
+            // the last line has no line break
+            lineEnd = data + len;
+        }
+        pos = lineEnd - data + (newline != nullptr ? 1 : 0);
+        if (parseLine(start, lineEnd, freq, word)) {
+            return true;
+        }
+    }
+}
+
+/* Returns the number of bytes read from the stream so far */
+size_t DictReader::bytesRead() const { return bytes; }
+
+/* Read the next block of the stream behind the unread bytes */
+void DictReader::fill() {
+    if (pos > 0 && pos == len) {
+        pos = len = 0;
+    }
+    if (len + BLOCK_SIZE > buffer.size()) {
+        if (pos > 0) {
+            // drop the lines already returned
+            memmove(data, data + pos, len - pos);
+            len -= pos;
+            pos = 0;
+        }
+        if (len + BLOCK_SIZE > buffer.size()) {
+            buffer.resize(len + BLOCK_SIZE);
+        }
+    }
+    data = buffer.data();
+    in->read(data + len, BLOCK_SIZE);
+    size_t count = in->gcount();
+    len += count;
+    bytes += count;
+    if (count == 0) {
+        eof = true;
+    }
+}
+
+/* Parse the line [line, lineEnd) in place: a frequency followed by words,
+ * which are moved left so that single spaces separate them. A "." word
+ * ends the entry, like it always has.
+ */
+bool DictReader::parseLine(char* line, char* lineEnd, unsigned int& freq,
+                           string_view& word) {
+    char* p = line;
+    while (p < lineEnd && isBlank(*p)) p++;
+    bool negative = false;
+    if (p < lineEnd && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+    from_chars_result parsed = from_chars(p, lineEnd, freq);
+    if (parsed.ec != errc()) {
+        return false;
+    }
+    if (negative) {
+        // istream wraps negative numbers around for unsigned types
+        freq = 0u - freq;
+    }
+    p = const_cast<char*>(parsed.ptr);
+
+    char* wordStart = p;
+    char* out = p;
+    while (true) {
+        while (p < lineEnd && isBlank(*p)) p++;
+        if (p == lineEnd) break;
+        char* token = p;
+        while (p < lineEnd && !isBlank(*p)) p++;
+        if (p - token == 1 && *token == '.') break;
+        if (out != wordStart) *out++ = ' ';
+        memmove(out, token, p - token);
+        out += p - token;
+    }
+    word = string_view(wordStart, out - wordStart);
+    return true;
+}
+
 /* Load all the words in word stream into the dictionary trie */
 void Utils::loadDict(DictionaryTrie& dict, istream& words) {
+    DictReader reader(words);
     unsigned int freq;
-    string data = "";
-    string tempWord;
-    string word;
-    vector<string> wordString;
-    unsigned int i;
-    while (getline(words, data)) {
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
-        }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
-        }
+    string_view word;
+    while (reader.next(freq, word)) {
         dict.insert(word, freq);
-        wordString.clear();
-        if (words.eof()) break;
     }
 }
 
 /* Load numWords from words stream into the dictionary trie */
 void Utils::loadDict(DictionaryTrie& dict, istream& words,
                      unsigned int numWords) {
+    DictReader reader(words);
     unsigned int freq;
-    string data = "";
-    string tempWord;
-    string word;
-    vector<string> wordString;
-    unsigned int i;
-    unsigned int j = 0;
-    for (; j < numWords; j++) {
-        getline(words, data);
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
-        }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
-        }
+    string_view word;
+    for (unsigned int j = 0; j < numWords && reader.next(freq, word); j++) {
         dict.insert(word, freq);
-        wordString.clear();
-        if (words.eof()) break;
     }
 }
 
 /* Load all the words in word stream into a vector */
 void Utils::loadDict(vector<string>& dict, istream& words) {
+    DictReader reader(words);
     unsigned int junk;
-    string data = "";
-    string tempWord;
-    string word;
-    vector<string> wordString;
-    unsigned int i;
-
-    while (getline(words, data)) {
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> junk;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
+    string_view word;
+    while (reader.next(junk, word)) {
+        dict.push_back(string(word));
+    }
+}
+
+/* Load all the words in word stream into an empty dictionary trie in one
+ * bulk build, which gives a balanced trie for sorted dictionary files.
+ * The words are views into the reader, which holds the whole file.
+ */
+void Utils::loadDictBulk(DictionaryTrie& dict, istream& words) {
+    DictReader reader(words, true);
+    unsigned int freq;
+    string_view word;
+    vector<pair<string_view, unsigned int>> entries;
+    while (reader.next(freq, word)) {
+        entries.push_back(pair<string_view, unsigned int>(word, freq));
+    }
+    dict.buildFromSorted(entries);
+}
+
+/* Load all the words in word stream into an empty dictionary trie in one
+ * bulk build, parsing and building with numThreads threads. The file is
+ * split at line breaks, and the entries of the parts are joined in file
+ * order, so the result is the same as the one of loadDictBulk.
+ */
+void Utils::loadDictParallel(DictionaryTrie& dict, istream& words,
+                             unsigned int numThreads) {
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+    vector<char> text;
+    size_t size = 0;
+    do {
+        text.resize(size + BLOCK_SIZE);
+        words.read(text.data() + size, BLOCK_SIZE);
+        size += words.gcount();
+    } while (words.gcount() > 0);
+    char* begin = text.data();
+    char* end = begin + size;
+
+    // cut the text into parts of about the same size at line breaks
+    vector<char*> cuts(1, begin);
+    for (unsigned int i = 1; i < numThreads; i++) {
+        char* cut = begin + size / numThreads * i;
+        if (cut < cuts.back()) {
+            continue;
+        }
+        char* newline = static_cast<char*>(memchr(cut, '\n', end - cut));
+        cut = newline == nullptr ? end : newline + 1;
+        if (cut != cuts.back()) {
+            cuts.push_back(cut);
         }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
+    }
+    cuts.push_back(end);
+
+    size_t numParts = cuts.size() - 1;
+    vector<vector<pair<string_view, unsigned int>>> parts(numParts);
+    vector<thread> threads;
+    for (size_t i = 0; i < numParts; i++) {
+        threads.emplace_back([&cuts, &parts, i]() {
+            DictReader reader(cuts[i], cuts[i + 1]);
+            unsigned int freq;
+            string_view word;
+            while (reader.next(freq, word)) {
+                parts[i].push_back(pair<string_view, unsigned int>(word, freq));
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    vector<pair<string_view, unsigned int>> entries;
+    for (vector<pair<string_view, unsigned int>>& part : parts) {
+        entries.insert(entries.end(), part.begin(), part.end());
+    }
+    dict.buildFromSorted(entries, numThreads);
+}
+
+/* Write the words with the given ids one per line, in the format of the
+ * dictionary file, straight from the text stored in the trie
+ */
+void Utils::writeWords(ostream& out, const DictionaryTrie& dict,
+                       const vector<uint32_t>& ids) {
+    for (uint32_t id : ids) {
+        out << dict.wordFrequency(id) << ' ' << dict.wordText(id) << '\n';
+    }
+}
+
+/* Returns the peak resident set size of this process in kilobytes */
+long Utils::peakMemoryKB() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+/* Returns a memory field of /proc/self/status in kilobytes, or -1 if the
+ * system has none
+ */
+static long statusKB(const string& field) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, field.length(), field) == 0 &&
+            line.length() > field.length() && line[field.length()] == ':') {
+            return atol(line.c_str() + field.length() + 1);
         }
-        dict.push_back(word);
-        wordString.clear();
-        if (words.eof()) break;
     }
+    return -1;
+}
+
+/* Starts measuring the memory of one phase of the benchmark. Writing 5 to
+ * clear_refs sets the peak back to the resident set size now, so that
+ * the peak read at the end of the phase belongs to the phase alone.
+ */
+long Utils::beginMemoryPhase() {
+    ofstream("/proc/self/clear_refs") << "5";
+    long resident = statusKB("VmRSS");
+    return resident >= 0 ? resident : peakMemoryKB();
+}
+
+/* Returns how far the resident set size rose above start at its peak since
+ * beginMemoryPhase. Without the peak of the phase, the peak of the process
+ * stands in for it, which is the same unless an earlier phase went higher.
+ */
+long Utils::phasePeakMemoryKB(long start) {
+    long peak = statusKB("VmHWM");
+    if (peak < 0) {
+        peak = peakMemoryKB();
+    }
+    return max(peak - start, 0L);
 }
@@ -8,6 +8,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <string_view>
 #include <vector>
 #include "DictionaryTrie.hpp"
 
@@ -28,6 +29,59 @@ class Timer {
     long long end_timer();
 };
 
+/** Reads a dictionary file entry by entry without allocating per line.
+ * The file is read in large blocks, the frequency is parsed in place and
+ * the whitespace inside the entry is collapsed to single spaces in the
+ * block itself, so every word is a view into the reader's buffer.
+ */
+class DictReader {
+  private:
+    // the stream, or nullptr when reading a range of memory
+    istream* in;
+    vector<char> buffer;
+    // the bytes read so far, either buffer.data() or the memory range
+    char* data;
+    // the unread bytes are data[pos, len)
+    size_t pos;
+    size_t len;
+    bool eof;
+    // the number of bytes taken from the stream
+    size_t bytes;
+
+  public:
+    /* It is the constructor.
+     * wholeFile: read the whole stream up front, so the words returned by
+     * next stay valid as long as the reader, not just until the next call
+     */
+    explicit DictReader(istream& in, bool wholeFile = false);
+
+    /* It is the constructor for a dictionary already in memory. The range
+     * is parsed in place, so the words returned by next point into it
+     */
+    DictReader(char* begin, char* end);
+
+    /* Read the next entry of the file. Lines without a frequency are
+     * skipped.
+     * freq, word: set to the frequency and the words of the entry joined
+     * with single spaces
+     * Returns false at the end of the file
+     */
+    bool next(unsigned int& freq, string_view& word);
+
+    /* Returns the number of bytes read from the stream so far */
+    size_t bytesRead() const;
+
+  private:
+    /* Read the next block of the stream behind the unread bytes */
+    void fill();
+
+    /* Parse the line [line, lineEnd) in place.
+     * Returns false if the line does not start with a frequency
+     */
+    static bool parseLine(char* line, char* lineEnd, unsigned int& freq,
+                          string_view& word);
+};
+
 /** Contains useful functions to parse input file */
 class Utils {
   public:
@@ -40,6 +94,38 @@ class Utils {
 
     /* Load all the words in word stream into a vector */
     void static loadDict(vector<string>& dict, istream& words);
+
+    /* Load all the words in the file into an empty dictionary with one
+     * balanced bulk build instead of one insert per line
+     */
+    void static loadDictBulk(DictionaryTrie& dict, istream& words);
+
+    /* Like loadDictBulk, but the file is split into numThreads parts that
+     * are parsed, sorted and built at the same time
+     */
+    void static loadDictParallel(DictionaryTrie& dict, istream& words,
+                                 unsigned int numThreads);
+
+    /* Write the words with the given ids one per line, in the format of
+     * the dictionary file, straight from the text stored in the trie
+     */
+    void static writeWords(ostream& out, const DictionaryTrie& dict,
+                           const vector<uint32_t>& ids);
+
+    /* Returns the peak resident set size of this process in kilobytes */
+    long static peakMemoryKB();
+
+    /* Starts measuring the memory of one phase of the benchmark: resets the
+     * peak resident set size of this process, where the kernel allows it,
+     * and returns the resident set size now in kilobytes
+     */
+    long static beginMemoryPhase();
+
+    /* Returns how far the resident set size of this process rose above
+     * start, the value beginMemoryPhase returned, at its peak since then,
+     * in kilobytes. Memory held from before the phase is not counted.
+     */
+    long static phasePeakMemoryKB(long start);
 };
 
 #endif  // UTIL_HPP
@@ -9,11 +9,16 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include "CompletionSession.hpp"
 #include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
 #include "util.hpp"
 
 using namespace std;
 
+// completions printed after every replayed keystroke
+const unsigned int KEYSTROKE_COMPLETIONS = 10;
+
 /* Check if a given data file is valid */
 bool fileValid(const char* fileName) {
     ifstream in;
@@ -36,39 +41,25 @@ bool fileValid(const char* fileName) {
     return true;
 }
 
-/* IMPORTANT! You should use the following lines of code to match the correct
- * output:
- *
- * cout << "This program needs exactly one argument!" << endl;
- * cout << "Reading file: " << file << endl;
- * cout << "Enter a prefix/pattern to search for:" << endl;
- * cout << "Enter a number of completions:" << endl;
- * cout << completion << endl;
- * cout << "Continue? (y/n)" << endl;
- *
- * arg 1 - Input file name (in format like freq_dict.txt)
- */
-int main(int argc, char** argv) {
-    const int NUM_ARG = 2;
-    if (argc != NUM_ARG) {
-        cout << "Invalid number of arguments.\n"
-             << "Usage: ./autocomplete <dictionary filename>" << endl;
-        return -1;
-    }
-    if (!fileValid(argv[1])) return -1;
-
-    DictionaryTrie* dt = new DictionaryTrie();
+/* Match a pattern with * [ ] ? or \ in it on a DictionaryTrie */
+vector<string> predictPattern(DictionaryTrie& trie, const string& pattern,
+                              unsigned int numCompletions) {
+    return trie.predictPattern(pattern, numCompletions);
+}
 
-    // Read all the tokens of the file in order to get every word
-    cout << "Reading file: " << argv[1] << endl;
+/* A snapshot only answers prefixes and underscores */
+vector<string> predictPattern(FrozenDictionaryTrie&, const string&,
+                              unsigned int) {
+    cout << "Patterns with * [ ] ? or \\ need a dictionary file." << endl;
+    return vector<string>();
+}
 
-    ifstream in;
-    in.open(argv[1], ios::binary);
+/* Prompt for prefixes/patterns and print their completions until the user
+ * stops
+ */
+template <typename Trie>
+void runPrompt(Trie& trie) {
     string word;
-
-    Utils::loadDict(*dt, in);
-    in.close();
-
     char cont = 'y';
     unsigned int numberOfCompletions;
     while (cont == 'y') {
@@ -77,23 +68,32 @@ int main(int argc, char** argv) {
         cout << "Enter a number of completions:" << endl;
         cin >> numberOfCompletions;
 
-        // determine whther word contains underscore
+        // determine whther word contains underscore, or the other
+        // wildcards of predictPattern
         bool containUnderscore = false;
+        bool containWildcard = false;
         for (int i = 0; i < word.length(); i++) {
             if (word[i] == '_') {
                 containUnderscore = true;
-                break;
+            } else if (word[i] == '*' || word[i] == '[' || word[i] == '?' ||
+                       word[i] == '\\') {
+                containWildcard = true;
             }
         }
 
         vector<string> vtr;
-        if (containUnderscore) {
-            vtr = dt->predictUnderscores(word, numberOfCompletions);
+        if (containWildcard) {
+            vtr = predictPattern(trie, word, numberOfCompletions);
+            for (string w : vtr) {
+                cout << w << endl;
+            }
+        } else if (containUnderscore) {
+            vtr = trie.predictUnderscores(word, numberOfCompletions);
             for (string w : vtr) {
                 cout << w << endl;
             }
         } else {
-            vtr = dt->predictCompletions(word, numberOfCompletions);
+            vtr = trie.predictCompletions(word, numberOfCompletions);
             for (string w : vtr) {
                 cout << w << endl;
             }
@@ -103,6 +103,121 @@ int main(int argc, char** argv) {
         cin >> cont;
         cin.ignore();
     }
-    delete dt;
+}
+
+/* Replay a stream of keystrokes through a CompletionSession and print the
+ * completions after every keystroke. A backspace (or delete) character
+ * removes the last letter and a line break starts a new prefix.
+ */
+void replayKeystrokes(DictionaryTrie& trie, istream& keys) {
+    CompletionSession session(trie);
+    Timer timer;
+    long long time = 0;
+    size_t count = 0;
+    char key;
+    while (keys.get(key)) {
+        if (key == '\n') {
+            session.reset();
+            continue;
+        } else if (key == '\r') {
+            continue;
+        }
+        timer.begin_timer();
+        if (key == '\b' || key == '\x7f') {
+            session.pop();
+        } else {
+            session.push(key);
+        }
+        vector<string> vtr = session.complete(KEYSTROKE_COMPLETIONS);
+        time += timer.end_timer();
+        count++;
+
+        cout << "\"" << session.prefix() << "\":";
+        if (!session.alive()) {
+            cout << " no word starts with this prefix";
+        }
+        for (size_t i = 0; i < vtr.size(); i++) {
+            cout << (i == 0 ? " " : ", ") << vtr[i];
+        }
+        cout << endl;
+    }
+    cout << "Replayed " << count << " keystrokes in " << time
+         << " nanoseconds." << endl;
+}
+
+/* IMPORTANT! You should use the following lines of code to match the correct
+ * output:
+ *
+ * cout << "This program needs exactly one argument!" << endl;
+ * cout << "Reading file: " << file << endl;
+ * cout << "Enter a prefix/pattern to search for:" << endl;
+ * cout << "Enter a number of completions:" << endl;
+ * cout << completion << endl;
+ * cout << "Continue? (y/n)" << endl;
+ *
+ * arg 1 - Input file name (in format like freq_dict.txt), or a snapshot
+ *         file written by snapshot.cpp.executable
+ * arg 2 - optional "--frozen" to answer the queries from a
+ *         FrozenDictionaryTrie, or "--keystrokes" followed by a file of
+ *         keystrokes to replay through a CompletionSession
+ */
+int main(int argc, char** argv) {
+    const int NUM_ARG = 2;
+    bool frozen = argc == NUM_ARG + 1 && string(argv[2]) == "--frozen";
+    bool keystrokes =
+        argc == NUM_ARG + 2 && string(argv[2]) == "--keystrokes";
+    if (argc != NUM_ARG && !frozen && !keystrokes) {
+        cout << "Invalid number of arguments.\n"
+             << "Usage: ./autocomplete <dictionary filename> [--frozen | "
+             << "--keystrokes <keystroke filename>]" << endl;
+        return -1;
+    }
+    if (!fileValid(argv[1])) return -1;
+    ifstream keys;
+    if (keystrokes) {
+        keys.open(argv[3], ios::binary);
+        if (!keys.is_open()) {
+            cout << "Invalid keystroke file. No file was opened.\n";
+            return -1;
+        }
+    }
+
+    // Read all the tokens of the file in order to get every word
+    cout << "Reading file: " << argv[1] << endl;
+
+    // a snapshot is mapped and queried in place, no loading needed
+    if (FrozenDictionaryTrie::isSnapshot(argv[1])) {
+        if (keystrokes) {
+            cout << "Keystrokes can only be replayed on a dictionary file.\n";
+            return -1;
+        }
+        FrozenDictionaryTrie* snapshot = FrozenDictionaryTrie::open(argv[1]);
+        if (snapshot == nullptr) {
+            cout << "Invalid snapshot file.\n";
+            return -1;
+        }
+        runPrompt(*snapshot);
+        delete snapshot;
+        return 0;
+    }
+
+    DictionaryTrie* dt = new DictionaryTrie();
+    ifstream in;
+    in.open(argv[1], ios::binary);
+
+    Utils::loadDict(*dt, in);
+    in.close();
+
+    if (keystrokes) {
+        replayKeystrokes(*dt, keys);
+        delete dt;
+    } else if (frozen) {
+        FrozenDictionaryTrie frozenTrie(*dt);
+        delete dt;
+        runPrompt(frozenTrie);
+    } else {
+        runPrompt(*dt);
+        delete dt;
+    }
     return 0;
 }
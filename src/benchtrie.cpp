@@ -1,26 +1,301 @@
 /**
  * Benchmark the autocomplete function in DictionaryTrie
  */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <fstream>
+#include <new>
+#include <random>
 #include <sstream>
+#include <thread>
+#include "AdaptiveTrie.hpp"
+#include "CachedDictionaryTrie.hpp"
 #include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
+#include "MinimizedDictionaryTrie.hpp"
+#include "RadixDictionaryTrie.hpp"
 #include "util.hpp"
 using namespace std;
 
-/* Test the runtime of autocompelte using different prefix and number of
- * completions
+// max number of results in the result cache
+const size_t CACHE_CAPACITY = 1024;
+// completions per prefix and longest prefix of the precomputed lists
+const unsigned int PRECOMPUTE_K = 10;
+const unsigned int PRECOMPUTE_DEPTH = 3;
+
+// number of heap allocations made so far, counted by operator new below
+atomic<size_t> allocations(0);
+
+/* Count every heap allocation of the benchmark, so that testAllocations can
+ * report how many a query makes. The replacements are kept out of line,
+ * where the compiler cannot mistake the malloc and free inside them for a
+ * mismatch with new and delete.
  */
-void testRuntime(string filename) {
-    const unsigned int NUM_COMP = 10;
+[[gnu::noinline]] void* operator new(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { free(p); }
 
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { free(p); }
+
+/* Returns the throughput in MB/s of handling the given bytes in time ns */
+double megabytesPerSecond(size_t bytes, long long time) {
+    return time > 0 ? bytes * 1000.0 / time : 0;
+}
+
+/* Parse the whole dictionary file without building anything and report the
+ * parser throughput
+ */
+void testParser(const string& filename) {
     ifstream in;
     in.open(filename, ios::binary);
 
-    // Testing student's trie
-    cout << "\nLoading dictionary..." << endl;
+    Timer timer;
+    timer.begin_timer();
+    DictReader reader(in);
+    unsigned int freq;
+    string_view word;
+    size_t count = 0;
+    while (reader.next(freq, word)) {
+        count++;
+    }
+    long long time = timer.end_timer();
+    cout << "\tParsed " << count << " entries in " << time << " nanoseconds, "
+         << megabytesPerSecond(reader.bytesRead(), time) << " MB/s." << endl;
+}
+
+/* Load the dictionary file into a new trie and report the load statistics
+ * bulk: build the trie in one balanced bulk load instead of line by line
+ */
+DictionaryTrie* loadTrie(const string& filename, bool bulk) {
+    ifstream in;
+    in.open(filename, ios::binary);
+    in.seekg(0, ios_base::end);
+    size_t bytes = in.tellg();
+    in.seekg(0, ios_base::beg);
 
+    long memory = Utils::beginMemoryPhase();
+    Timer timer;
+    timer.begin_timer();
     DictionaryTrie* trie = new DictionaryTrie();
-    Utils::loadDict(*trie, in);
+    if (bulk) {
+        Utils::loadDictBulk(*trie, in);
+    } else {
+        Utils::loadDict(*trie, in);
+    }
+    long long time = timer.end_timer();
+    cout << "\tLoad time: " << time << " nanoseconds, "
+         << megabytesPerSecond(bytes, time) << " MB/s." << endl;
+    long peak = Utils::phasePeakMemoryKB(memory);
+    cout << "\tPeak memory of the load: " << peak << " KB";
+    if (bulk) {
+        // the parsed entries and their sorted copy are gone once it is built
+        long kept = (long)(trie->memoryUsage() / 1024);
+        cout << ", " << max(peak - kept, 0L)
+             << " KB of it for the parsed entries";
+    }
+    cout << "." << endl;
+    cout << "\tNodes: " << trie->nodeCount() << ", "
+         << trie->memoryUsage() / 1024 << " KB reserved." << endl;
+    cout << "\tAverage descent depth: " << trie->averageDepth() << endl;
+    return trie;
+}
+
+/* Load the dictionary file in parallel with several thread counts and
+ * report the load time of each
+ */
+void testParallelLoad(const string& filename) {
+    vector<unsigned int> threadCounts = {1, 2, 4};
+    unsigned int cores = thread::hardware_concurrency();
+    if (cores > 4) {
+        threadCounts.push_back(cores);
+    }
+    for (unsigned int numThreads : threadCounts) {
+        ifstream in;
+        in.open(filename, ios::binary);
+        Timer timer;
+        timer.begin_timer();
+        DictionaryTrie trie;
+        Utils::loadDictParallel(trie, in, numThreads);
+        long long time = timer.end_timer();
+        cout << "\t" << numThreads << " thread(s): " << time
+             << " nanoseconds, " << trie.nodeCount() << " nodes." << endl;
+    }
+}
+
+/* Answer one batch of short prefixes and patterns with several thread
+ * counts and report the throughput of each
+ */
+void testBatch(DictionaryTrie* trie) {
+    const unsigned int NUM_COMP = 10;
+    vector<DictionaryTrie::BatchQuery> queries;
+    for (char c1 = 'a'; c1 <= 'z'; c1++) {
+        queries.push_back({string(1, c1), NUM_COMP, false});
+        queries.push_back({string(1, c1) + "__", NUM_COMP, true});
+        for (char c2 = 'a'; c2 <= 'z'; c2++) {
+            queries.push_back({string{c1, c2}, NUM_COMP, false});
+        }
+    }
+
+    vector<unsigned int> threadCounts = {1, 2, 4};
+    unsigned int cores = thread::hardware_concurrency();
+    if (cores > 4) {
+        threadCounts.push_back(cores);
+    }
+    for (unsigned int numThreads : threadCounts) {
+        vector<vector<string>> results;
+        Timer timer;
+        timer.begin_timer();
+        trie->predictCompletionsBatch(queries, results, numThreads);
+        long long time = timer.end_timer();
+        cout << "\t" << numThreads << " thread(s): " << queries.size()
+             << " queries in " << time << " nanoseconds, "
+             << (time > 0 ? queries.size() * 1e9 / time : 0)
+             << " queries/second." << endl;
+    }
+}
+
+/* Build a copy of the trie in one bulk load, shaped like the bulk loaded
+ * dictionary, for the sections that change the words they run on
+ */
+DictionaryTrie* bulkCopy(DictionaryTrie* trie) {
+    vector<pair<string_view, unsigned int>> entries;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        entries.push_back({trie->wordText(id), trie->wordFrequency(id)});
+    }
+    DictionaryTrie* copy = new DictionaryTrie();
+    copy->buildFromSorted(entries);
+    return copy;
+}
+
+/* Time the standard prefixes with no writer and then while another thread
+ * keeps inserting new words, and report the average query latency of both.
+ * Both run on a copy of the trie, which keeps the words the writer adds.
+ */
+void testReadersWithWriter(DictionaryTrie* source) {
+    const unsigned int NUM_COMP = 10;
+    const int ROUNDS = 200;
+    vector<string> prefixes = {"a", "the", "app", "man"};
+    DictionaryTrie* trie = bulkCopy(source);
+
+    for (bool writing : {false, true}) {
+        atomic<bool> stop(false);
+        thread writer;
+        if (writing) {
+            writer = thread([trie, &stop]() {
+                for (int i = 0; !stop.load(); i++) {
+                    trie->insert("zz" + to_string(i), i);
+                }
+            });
+        }
+        Timer timer;
+        timer.begin_timer();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (const string& prefix : prefixes) {
+                trie->predictCompletions(prefix, NUM_COMP);
+            }
+        }
+        long long time = timer.end_timer();
+        stop = true;
+        if (writing) {
+            writer.join();
+        }
+        cout << "\t" << (writing ? "With" : "Without")
+             << " a writer: " << time / (ROUNDS * prefixes.size())
+             << " nanoseconds per query." << endl;
+    }
+    delete trie;
+}
+
+/* Count the heap allocations of the standard prefix queries, once through
+ * the call that returns a new list and once through the call that fills a
+ * list kept across queries, with both searches, and report the average per
+ * query. The first round of the buffer call warms the buffers up and is
+ * not counted.
+ */
+void testAllocations(DictionaryTrie* trie) {
+    const unsigned int NUM_COMP = 10;
+    const int ROUNDS = 100;
+    vector<string> prefixes = {"", "a", "th", "the", "app", "man"};
+
+    for (DictionaryTrie::TopKSearch search :
+         {DictionaryTrie::DEPTH_FIRST, DictionaryTrie::BEST_FIRST}) {
+        trie->setTopKSearch(search);
+        size_t queries = ROUNDS * prefixes.size();
+        size_t before = allocations.load();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (const string& prefix : prefixes) {
+                trie->predictCompletions(prefix, NUM_COMP);
+            }
+        }
+        size_t returned = allocations.load() - before;
+
+        vector<string> results;
+        for (const string& prefix : prefixes) {
+            trie->predictCompletions(prefix, NUM_COMP, results);
+        }
+        before = allocations.load();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (const string& prefix : prefixes) {
+                trie->predictCompletions(prefix, NUM_COMP, results);
+            }
+        }
+        size_t reused = allocations.load() - before;
+
+        cout << "\t"
+             << (search == DictionaryTrie::DEPTH_FIRST ? "Depth" : "Best")
+             << " first: " << (double)returned / queries
+             << " allocations per query returning a new list, "
+             << (double)reused / queries
+             << " filling a reused list." << endl;
+    }
+    trie->setTopKSearch(DictionaryTrie::DEPTH_FIRST);
+}
+
+/* Replay a skewed stream of prefix queries against the trie, first
+ * directly and then through a result cache, and report both runtimes and
+ * the cache counters
+ */
+void testCache(DictionaryTrie* trie) {
+    const unsigned int NUM_COMP = 10;
+    const int ROUNDS = 1000;
+    // a few hot prefixes asked over and over, as in real traffic
+    vector<string> prefixes = {"a", "th", "app", "the", "a", "man", "th"};
+
+    Timer timer;
+    timer.begin_timer();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const string& prefix : prefixes) {
+            trie->predictCompletions(prefix, NUM_COMP);
+        }
+    }
+    long long time = timer.end_timer();
+    cout << "\tUncached: " << time << " nanoseconds." << endl;
+
+    CachedDictionaryTrie cached(*trie, CACHE_CAPACITY);
+    timer.begin_timer();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const string& prefix : prefixes) {
+            cached.predictCompletions(prefix, NUM_COMP);
+        }
+    }
+    time = timer.end_timer();
+    cout << "\tCached: " << time << " nanoseconds, " << cached.hits()
+         << " hits, " << cached.misses() << " misses, " << cached.size()
+         << " results cached." << endl;
+}
+
+/* Run the standard prefix queries against a trie and print their runtime */
+template <typename Trie>
+void runQueries(Trie* trie) {
+    const unsigned int NUM_COMP = 10;
 
     Timer timer;
     vector<string> results;
@@ -70,6 +345,475 @@ void testRuntime(string filename) {
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
     cout << "\tResults found: " << results.size() << endl;
+}
+
+/* Run wildcard patterns of growing cost against the trie and print the
+ * runtime of each, with a few numbers of completions
+ */
+template <typename Trie>
+void runPatterns(Trie* trie) {
+    vector<string> patterns = {"th_",  "a___e",    "s___s",     "_a__e_",
+                               "____", "_____ing", "__________"};
+    Timer timer;
+    for (const string& pattern : patterns) {
+        cout << "\tPattern \"" << pattern << "\":";
+        for (unsigned int numCompletions : {1, 10, 100}) {
+            timer.begin_timer();
+            vector<string> results =
+                trie->predictUnderscores(pattern, numCompletions);
+            long long time = timer.end_timer();
+            cout << " k = " << numCompletions << " in " << time << " ns ("
+                 << results.size() << " found)"
+                 << (numCompletions == 100 ? "" : ",");
+        }
+        cout << endl;
+    }
+}
+
+/* Test the runtime of predictPattern on a few patterns with * [ ] and ? */
+void runAutomaton(DictionaryTrie* trie) {
+    vector<string> patterns = {"colou?r", "[aeiou]*[aeiou]", "s[^aeiou]*s",
+                               "b_*_d", "*ing", "*q*u*"};
+    Timer timer;
+    for (const string& pattern : patterns) {
+        cout << "\tPattern \"" << pattern << "\":";
+        for (unsigned int numCompletions : {1, 10, 100}) {
+            timer.begin_timer();
+            vector<string> results =
+                trie->predictPattern(pattern, numCompletions);
+            long long time = timer.end_timer();
+            cout << " k = " << numCompletions << " in " << time << " ns ("
+                 << results.size() << " found)"
+                 << (numCompletions == 100 ? "" : ",");
+        }
+        cout << endl;
+    }
+}
+
+/* Time predictFuzzy on a few mistyped prefixes with up to 1 and 2 edits,
+ * and report the average and the slowest query of each
+ */
+void testFuzzy(DictionaryTrie* trie) {
+    const unsigned int NUM_COMP = 10;
+    vector<string> typos = {"aplp",    "teh",        "recieve", "ysterday",
+                            "wrold",   "goverment",  "thier",   "pepole",
+                            "becuase", "definately", "accomodate"};
+    Timer timer;
+    for (unsigned int maxEdits : {1, 2}) {
+        long long total = 0;
+        long long slowest = 0;
+        for (const string& typo : typos) {
+            timer.begin_timer();
+            trie->predictFuzzy(typo, maxEdits, NUM_COMP);
+            long long time = timer.end_timer();
+            total += time;
+            slowest = max(slowest, time);
+        }
+        cout << "\t" << maxEdits << " edit(s): " << total / typos.size()
+             << " nanoseconds per query, " << slowest << " at most." << endl;
+    }
+}
+
+/* Change the frequencies of random words, one delta at a time and then in
+ * one large batch, and compare the batch with building the trie again
+ * with the new frequencies. The changes go to a copy of the trie.
+ */
+void testFrequencyUpdates(DictionaryTrie* source) {
+    const size_t NUM_SINGLE = 100000;
+    const size_t NUM_BATCH = 1000000;
+    DictionaryTrie* trie = bulkCopy(source);
+    vector<pair<string_view, long long>> deltas;
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < NUM_BATCH; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t id = 1 + (seed >> 8) % trie->wordCount();
+        deltas.push_back({trie->wordText(id), (long long)(seed % 201) - 100});
+    }
+
+    Timer timer;
+    timer.begin_timer();
+    for (size_t i = 0; i < NUM_SINGLE; i++) {
+        trie->addFrequency(deltas[i].first, deltas[i].second);
+    }
+    long long time = timer.end_timer();
+    cout << "\tOne at a time: " << time / NUM_SINGLE
+         << " nanoseconds per delta." << endl;
+
+    timer.begin_timer();
+    trie->addFrequencies(deltas);
+    time = timer.end_timer();
+    cout << "\tBatch of " << NUM_BATCH << " by text: " << time
+         << " nanoseconds." << endl;
+
+    vector<pair<uint32_t, long long>> idDeltas;
+    for (const pair<string_view, long long>& delta : deltas) {
+        idDeltas.push_back({trie->wordId(delta.first), delta.second});
+    }
+    timer.begin_timer();
+    trie->addFrequencies(idDeltas);
+    time = timer.end_timer();
+    cout << "\tBatch of " << NUM_BATCH << " by id: " << time
+         << " nanoseconds." << endl;
+
+    vector<pair<string_view, unsigned int>> entries;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        entries.push_back({trie->wordText(id), trie->wordFrequency(id)});
+    }
+    timer.begin_timer();
+    DictionaryTrie rebuilt;
+    rebuilt.buildFromSorted(entries);
+    time = timer.end_timer();
+    cout << "\tRebuild: " << time << " nanoseconds." << endl;
+    delete trie;
+}
+
+/* Erase a tenth of the words, in no particular order, one at a time and
+ * then in one batch, and report both times. Each runs on its own bulk
+ * built copy of the trie, so both start from the same shape and the trie
+ * itself keeps its words.
+ */
+void testErase(DictionaryTrie* trie) {
+    vector<string> erased;
+    for (uint32_t id = 1; id <= trie->wordCount(); id += 10) {
+        erased.push_back(string(trie->wordText(id)));
+    }
+    shuffle(erased.begin(), erased.end(), mt19937(12345));
+    vector<string_view> texts(erased.begin(), erased.end());
+
+    DictionaryTrie* copy = bulkCopy(trie);
+    size_t numNodes = copy->nodeCount();
+    Timer timer;
+    timer.begin_timer();
+    for (string_view text : texts) {
+        copy->erase(text);
+    }
+    long long time = timer.end_timer();
+    cout << "\tOne at a time: " << time / texts.size()
+         << " nanoseconds per word, " << numNodes - copy->nodeCount()
+         << " nodes freed." << endl;
+    delete copy;
+
+    copy = bulkCopy(trie);
+    timer.begin_timer();
+    copy->eraseAll(texts);
+    time = timer.end_timer();
+    cout << "\tBatch of " << texts.size() << ": " << time << " nanoseconds."
+         << endl;
+    delete copy;
+}
+
+/* Look every word up, and every word with its last letter changed so that
+ * it misses, then insert all the words into a new trie, with the root
+ * table and with the plain walk from the root, and report all three
+ */
+void testRootTable(DictionaryTrie* trie) {
+    vector<string> hits;
+    vector<string> misses;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        hits.push_back(string(trie->wordText(id)));
+        misses.push_back(hits.back());
+        misses.back().back() = '\x7f';
+    }
+    shuffle(hits.begin(), hits.end(), mt19937(12345));
+    shuffle(misses.begin(), misses.end(), mt19937(54321));
+
+    Timer timer;
+    for (bool table : {true, false}) {
+        trie->setRootTable(table);
+        cout << (table ? "\tRoot table:" : "\tPlain walk:") << endl;
+        for (const vector<string>* words : {&hits, &misses}) {
+            size_t found = 0;
+            timer.begin_timer();
+            for (const string& word : *words) {
+                found += trie->wordId(word) != 0;
+            }
+            long long time = timer.end_timer();
+            cout << "\t\t" << (words == &hits ? "Hits: " : "Misses: ")
+                 << time / words->size() << " nanoseconds per lookup, "
+                 << found << " found." << endl;
+        }
+
+        DictionaryTrie fresh;
+        fresh.setRootTable(table);
+        timer.begin_timer();
+        for (const string& word : hits) {
+            fresh.insert(word, 1);
+        }
+        long long time = timer.end_timer();
+        cout << "\t\tInserts: " << time / hits.size()
+             << " nanoseconds per word." << endl;
+    }
+    trie->setRootTable(true);
+}
+
+/* Look every word of the trie up in another engine and in the trie, and
+ * every word with its last letter changed so that it misses, and report
+ * the time per lookup of both
+ */
+template <typename Trie>
+void compareLookups(DictionaryTrie* trie, Trie* other) {
+    vector<string> hits;
+    vector<string> misses;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        hits.push_back(string(trie->wordText(id)));
+        misses.push_back(hits.back());
+        misses.back().back() = '\x7f';
+    }
+    shuffle(hits.begin(), hits.end(), mt19937(12345));
+    shuffle(misses.begin(), misses.end(), mt19937(54321));
+
+    Timer timer;
+    for (const vector<string>* words : {&hits, &misses}) {
+        size_t otherFound = 0;
+        timer.begin_timer();
+        for (const string& word : *words) {
+            otherFound += other->find(word);
+        }
+        long long otherTime = timer.end_timer();
+        size_t tstFound = 0;
+        timer.begin_timer();
+        for (const string& word : *words) {
+            tstFound += trie->wordId(word) != 0;
+        }
+        long long tstTime = timer.end_timer();
+        cout << "\t" << (words == &hits ? "Hits: " : "Misses: ")
+             << otherTime / words->size() << " nanoseconds per lookup, "
+             << otherFound << " found; " << tstTime / words->size()
+             << " and " << tstFound << " in the TST." << endl;
+    }
+}
+
+/* Insert the words of the trie into another engine and report the load
+ * time. The file is sorted, so the words go in shuffled, which keeps the
+ * sibling chains of a TST about as shallow as the balanced bulk load.
+ */
+template <typename Trie>
+Trie* copyTrie(DictionaryTrie* trie) {
+    vector<uint32_t> ids;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        ids.push_back(id);
+    }
+    shuffle(ids.begin(), ids.end(), mt19937(2024));
+
+    Timer timer;
+    timer.begin_timer();
+    Trie* copy = new Trie();
+    for (uint32_t id : ids) {
+        copy->insert(trie->wordText(id), trie->wordFrequency(id));
+    }
+    long long time = timer.end_timer();
+    cout << "\tLoad time: " << time << " nanoseconds." << endl;
+    return copy;
+}
+
+/* Insert the words of the trie into an adaptive radix trie, run the
+ * standard queries and patterns on it, and compare its lookups with the
+ * ones of the ternary search tree
+ */
+void testAdaptive(DictionaryTrie* trie) {
+    AdaptiveTrie* art = copyTrie<AdaptiveTrie>(trie);
+    vector<size_t> layouts = art->layoutCounts();
+    cout << "\tNodes: " << art->nodeCount() << " (" << layouts[0] << " of 4, "
+         << layouts[1] << " of 16, " << layouts[2] << " of 48, "
+         << layouts[3] << " of 256), " << art->memoryUsage() / 1024
+         << " KB reserved." << endl;
+    compareLookups(trie, art);
+    runQueries(art);
+    cout << endl;
+    runPatterns(art);
+    delete art;
+}
+
+/* Load the words of the trie into a path-compressed TST, once by inserts
+ * and once in bulk, and compare their nodes, memory and lookups with the
+ * ones of the trie. The queries and patterns run on the bulk one.
+ */
+void testRadix(DictionaryTrie* trie) {
+    RadixDictionaryTrie* inserted = copyTrie<RadixDictionaryTrie>(trie);
+    cout << "\tNodes: " << inserted->nodeCount() << ", "
+         << inserted->memoryUsage() / 1024 << " KB reserved; "
+         << trie->nodeCount() << " and " << trie->memoryUsage() / 1024
+         << " KB in the TST." << endl;
+    compareLookups(trie, inserted);
+    delete inserted;
+
+    vector<pair<string_view, unsigned int>> entries;
+    for (uint32_t id = 1; id <= trie->wordCount(); id++) {
+        entries.push_back({trie->wordText(id), trie->wordFrequency(id)});
+    }
+    Timer timer;
+    timer.begin_timer();
+    RadixDictionaryTrie* radix = new RadixDictionaryTrie();
+    radix->buildFromSorted(entries);
+    long long time = timer.end_timer();
+    cout << "\tBulk load time: " << time << " nanoseconds." << endl;
+    cout << "\tNodes: " << radix->nodeCount() << ", "
+         << radix->memoryUsage() / 1024 << " KB reserved." << endl;
+    compareLookups(trie, radix);
+    runQueries(radix);
+    cout << endl;
+    runPatterns(radix);
+    delete radix;
+}
+
+/* Minimize the words of the trie into an acyclic automaton, and compare its
+ * states, memory, lookups, queries and patterns with the ones of the trie
+ */
+void testMinimized(DictionaryTrie* trie) {
+    Timer timer;
+    timer.begin_timer();
+    MinimizedDictionaryTrie* dafsa = new MinimizedDictionaryTrie(*trie);
+    long long time = timer.end_timer();
+    cout << "\tBuild time: " << time << " nanoseconds." << endl;
+    cout << "\tStates: " << dafsa->nodeCount() << " with "
+         << dafsa->edgeCount() << " edges, " << dafsa->memoryUsage() / 1024
+         << " KB reserved; " << trie->nodeCount() << " nodes and "
+         << trie->memoryUsage() / 1024 << " KB in the TST." << endl;
+    compareLookups(trie, dafsa);
+    runQueries(dafsa);
+    cout << endl;
+    runPatterns(dafsa);
+    delete dafsa;
+}
+
+/* Test the runtime of autocompelte using different prefix and number of
+ * completions
+ */
+void testRuntime(string filename) {
+    Timer timer;
+    vector<string> results;
+    long long time = 0;
+
+    // Testing a snapshot, which is opened instead of loaded
+    if (FrozenDictionaryTrie::isSnapshot(filename)) {
+        cout << "\nOpening snapshot..." << endl;
+        timer.begin_timer();
+        FrozenDictionaryTrie* snapshot = FrozenDictionaryTrie::open(filename);
+        time = timer.end_timer();
+        if (snapshot == nullptr) {
+            cout << "Invalid snapshot file." << endl;
+            return;
+        }
+        cout << "\tOpen time: " << time << " nanoseconds." << endl;
+        cout << "\tNodes: " << snapshot->nodeCount() << ", "
+             << snapshot->memoryUsage() / 1024 << " KB mapped." << endl;
+        runQueries(snapshot);
+        cout << "\tPeak memory: " << Utils::peakMemoryKB() << " KB." << endl;
+        delete snapshot;
+        return;
+    }
+
+    // Testing the dictionary parser alone
+    cout << "\nParsing dictionary..." << endl;
+    testParser(filename);
+
+    // Testing student's trie
+    cout << "\nLoading dictionary..." << endl;
+    DictionaryTrie* trie = loadTrie(filename, false);
+    runQueries(trie);
+
+    // Testing the same dictionary built in one balanced bulk load
+    cout << "\nLoading dictionary in bulk..." << endl;
+    DictionaryTrie* bulkTrie = loadTrie(filename, true);
+    runQueries(bulkTrie);
+
+    // Testing wildcard patterns on the bulk loaded trie
+    cout << "\nMatching wildcard patterns..." << endl;
+    runPatterns(bulkTrie);
+
+    // Testing the same patterns with the positional pattern index
+    cout << "\nIndexing patterns..." << endl;
+    timer.begin_timer();
+    bulkTrie->buildPatternIndex();
+    time = timer.end_timer();
+    cout << "\tIndex time: " << time << " nanoseconds." << endl;
+    cout << "\tIndex: " << bulkTrie->patternIndexMemoryUsage() / 1024
+         << " KB." << endl;
+    runPatterns(bulkTrie);
+
+    // Testing patterns with * [ ] and ?, run in lockstep with the trie
+    cout << "\nMatching patterns with an automaton..." << endl;
+    runAutomaton(bulkTrie);
+
+    // Testing completions of mistyped prefixes
+    cout << "\nCompleting mistyped prefixes..." << endl;
+    testFuzzy(bulkTrie);
+
+    // Testing the same trie with the best-first top-k search
+    cout << "\nSearching best first..." << endl;
+    bulkTrie->setTopKSearch(DictionaryTrie::BEST_FIRST);
+    runQueries(bulkTrie);
+    bulkTrie->setTopKSearch(DictionaryTrie::DEPTH_FIRST);
+
+    // Testing lookups through the root table against the plain walk
+    cout << "\nLooking words up..." << endl;
+    testRootTable(bulkTrie);
+
+    // Testing the same words in an adaptive radix trie
+    cout << "\nLoading an adaptive radix trie..." << endl;
+    testAdaptive(bulkTrie);
+
+    // Testing the same words in a path-compressed TST
+    cout << "\nLoading a path-compressed trie..." << endl;
+    testRadix(bulkTrie);
+
+    // Testing the same words in a minimized automaton
+    cout << "\nMinimizing into an automaton..." << endl;
+    testMinimized(bulkTrie);
+
+    // Testing batches of queries spread over several threads
+    cout << "\nAnswering a batch of queries..." << endl;
+    testBatch(bulkTrie);
+
+    // Testing a result cache in front of the bulk loaded trie
+    cout << "\nReplaying hot prefixes..." << endl;
+    testCache(bulkTrie);
+
+    // Testing how many heap allocations a query makes
+    cout << "\nCounting allocations..." << endl;
+    testAllocations(bulkTrie);
+
+    // Testing lock-free queries next to a writer
+    cout << "\nQuerying while inserting..." << endl;
+    testReadersWithWriter(bulkTrie);
+
+    // Testing the bulk loaded trie with precomputed completions
+    cout << "\nPrecomputing completions (k = " << PRECOMPUTE_K
+         << ", prefixes of up to " << PRECOMPUTE_DEPTH << " letters)..."
+         << endl;
+    timer.begin_timer();
+    bulkTrie->precomputeCompletions(PRECOMPUTE_K, PRECOMPUTE_DEPTH);
+    time = timer.end_timer();
+    cout << "\tPrecompute time: " << time << " nanoseconds." << endl;
+    cout << "\tLists: " << bulkTrie->precomputedMemoryUsage() / 1024
+         << " KB." << endl;
+    runQueries(bulkTrie);
+    bulkTrie->precomputeCompletions(0, 0);
+
+    // Testing frequency changes against building the trie again
+    cout << "\nUpdating frequencies..." << endl;
+    testFrequencyUpdates(bulkTrie);
+
+    // Testing word removal, one by one and in a batch
+    cout << "\nErasing words..." << endl;
+    testErase(bulkTrie);
+
+    // Testing the bulk load spread over several threads
+    cout << "\nLoading dictionary in parallel ("
+         << thread::hardware_concurrency() << " cores)..." << endl;
+    testParallelLoad(filename);
+
+    // Testing the bulk loaded trie frozen into a read-only layout
+    cout << "\nFreezing dictionary..." << endl;
+    timer.begin_timer();
+    FrozenDictionaryTrie* frozenTrie = new FrozenDictionaryTrie(*bulkTrie);
+    time = timer.end_timer();
+    cout << "\tFreeze time: " << time << " nanoseconds." << endl;
+    cout << "\tNodes: " << frozenTrie->nodeCount() << ", "
+         << frozenTrie->memoryUsage() / 1024 << " KB with the words." << endl;
+    delete bulkTrie;
+    runQueries(frozenTrie);
+    delete frozenTrie;
 
     // Addtional tests
     cout << "\nWould you like to run additional tests? (y/n) ";
@@ -97,7 +841,11 @@ void testRuntime(string filename) {
             cout << "Enter prefix: ";
         }
     }
+
+    timer.begin_timer();
     delete trie;
+    time = timer.end_timer();
+    cout << "\nTeardown time: " << time << " nanoseconds." << endl;
 }
 
 /* Check if a given data file is valid */
@@ -128,7 +876,8 @@ int main(int argc, char* argv[]) {
 
     if (argc != NUM_ARG) {
         cout << "Invalid number of arguments.\n"
-             << "Usage: ./benchtrie <dictionary filename>" << endl;
+             << "Usage: ./benchtrie <dictionary or snapshot filename>"
+             << endl;
         return -1;
     }
 
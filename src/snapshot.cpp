@@ -0,0 +1,50 @@
+/*
+ * This file builds a dictionary once and saves it as a snapshot file,
+ * which autocomplete and benchtrie can open instantly instead of parsing
+ * the dictionary again.
+ *
+ * Author: Yuening YANG, Shenlang ZHOU
+ * Email: y3yang@ucsd.edu, shzhou@ucsd.edu
+ */
+#include <fstream>
+#include <iostream>
+#include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+/* arg 1 - Input file name (in format like freq_dict.txt)
+ * arg 2 - Output snapshot file name
+ */
+int main(int argc, char** argv) {
+    const int NUM_ARG = 3;
+    if (argc != NUM_ARG) {
+        cout << "Invalid number of arguments.\n"
+             << "Usage: ./snapshot <dictionary filename> <snapshot filename>"
+             << endl;
+        return -1;
+    }
+
+    ifstream in;
+    in.open(argv[1], ios::binary);
+    if (!in.is_open()) {
+        cout << "Invalid input file. No file was opened. Please try again.\n";
+        return -1;
+    }
+
+    cout << "Reading file: " << argv[1] << endl;
+    DictionaryTrie* dt = new DictionaryTrie();
+    Utils::loadDictBulk(*dt, in);
+    in.close();
+
+    FrozenDictionaryTrie frozen(*dt);
+    delete dt;
+    if (!frozen.save(argv[2])) {
+        cout << "Failed to write snapshot: " << argv[2] << endl;
+        return -1;
+    }
+    cout << "Wrote snapshot: " << argv[2] << " (" << frozen.nodeCount()
+         << " nodes, " << frozen.memoryUsage() << " bytes)" << endl;
+    return 0;
+}
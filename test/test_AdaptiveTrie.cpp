@@ -0,0 +1,126 @@
+/**
+ * This File tests all the methods implemented in
+ * AdaptiveTrie, against the answers of a DictionaryTrie.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "AdaptiveTrie.hpp"
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/**
+ * Inserts a small dictionary with tied frequencies
+ */
+class SmallAdaptiveTrieFixture : public ::testing::Test {
+  protected:
+    AdaptiveTrie trie;
+
+  public:
+    SmallAdaptiveTrieFixture() {
+        vector<string> inputs{"cat", "car", "cab", "bat",  "bar",
+                              "a",   "at",  "cart", "care", "cast"};
+        vector<unsigned int> freqs{5, 9, 5, 7, 9, 3, 1, 2, 2, 8};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            trie.insert(inputs[i], freqs[i]);
+        }
+    }
+};
+
+/* Empty test */
+TEST(AdaptiveTrieTests, EMPTY_TEST) {
+    AdaptiveTrie trie;
+    EXPECT_FALSE(trie.find("abrakadabra"));
+    EXPECT_FALSE(trie.find(""));
+    EXPECT_FALSE(trie.insert("", 3));
+    EXPECT_TRUE(trie.predictCompletions("", 10).empty());
+    EXPECT_TRUE(trie.predictUnderscores("a_", 10).empty());
+    EXPECT_EQ(trie.nodeCount(), 0);
+}
+
+TEST_F(SmallAdaptiveTrieFixture, SMALL_FIND_TEST) {
+    EXPECT_TRUE(trie.find("cart"));
+    EXPECT_TRUE(trie.find("a"));
+    EXPECT_FALSE(trie.find("ca"));
+    EXPECT_FALSE(trie.find("carts"));
+    EXPECT_FALSE(trie.find("b"));
+    EXPECT_FALSE(trie.insert("cab", 100));
+    // expect one node per prefix, the empty one too
+    EXPECT_EQ(trie.nodeCount(), 16);
+}
+
+TEST_F(SmallAdaptiveTrieFixture, SMALL_PREDICT_TEST) {
+    vector<string> expected{"bar", "car", "cast", "bat"};
+    EXPECT_EQ(trie.predictCompletions("", 4), expected);
+    expected = {"car", "cast", "cab", "cat", "care", "cart"};
+    EXPECT_EQ(trie.predictCompletions("ca", 10), expected);
+    EXPECT_TRUE(trie.predictCompletions("cb", 10).empty());
+    EXPECT_TRUE(trie.predictCompletions("car", 0).empty());
+    expected = {"bar", "car", "bat"};
+    EXPECT_EQ(trie.predictUnderscores("_a_", 3), expected);
+    expected = {"cast", "care", "cart"};
+    EXPECT_EQ(trie.predictUnderscores("ca__", 10), expected);
+    expected = {"at"};
+    EXPECT_EQ(trie.predictUnderscores("at", 10), expected);
+}
+
+/* expect every layout to give the answers of the ternary search tree,
+ *      with nodes of all four sizes and inserts in no particular order
+ */
+TEST(AdaptiveTrieTests, LAYOUT_TEST) {
+    AdaptiveTrie trie;
+    DictionaryTrie dict;
+    unsigned int seed = 31415;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    // the first letter from 80 bytes, the next ones from fewer and fewer
+    auto randomWord = [&random]() {
+        string word(1 + random(4), ' ');
+        for (size_t i = 0; i < word.length(); i++) {
+            word[i] = '0' + random(i == 0 ? 80 : 20 / i);
+        }
+        return word;
+    };
+
+    vector<string> words;
+    for (int i = 0; i < 5000; i++) {
+        string word = randomWord();
+        unsigned int freq = random(100);
+        EXPECT_EQ(trie.insert(word, freq), dict.insert(word, freq));
+        words.push_back(word);
+    }
+    vector<size_t> counts = trie.layoutCounts();
+    for (size_t count : counts) {
+        EXPECT_GT(count, 0);
+    }
+    EXPECT_EQ(trie.nodeCount(), dict.nodeCount() + 1);
+
+    for (int i = 0; i < 500; i++) {
+        string word = randomWord();
+        EXPECT_EQ(trie.find(word), dict.find(word));
+    }
+    for (const string& word : words) {
+        EXPECT_TRUE(trie.find(word));
+        for (unsigned int k : {1, 5, 50}) {
+            string prefix = word.substr(0, random(word.length()));
+            EXPECT_EQ(trie.predictCompletions(prefix, k),
+                      dict.predictCompletions(prefix, k));
+        }
+    }
+    vector<string> patterns{"_", "1_", "__", "_1_", "___", "____"};
+    for (const string& pattern : patterns) {
+        for (unsigned int k : {1, 10, 1000}) {
+            EXPECT_EQ(trie.predictUnderscores(pattern, k),
+                      dict.predictUnderscores(pattern, k));
+        }
+    }
+}
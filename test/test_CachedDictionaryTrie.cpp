@@ -0,0 +1,211 @@
+/**
+ * This File tests all the methods implemented in
+ * CachedDictionaryTrie, by comparing cached answers with the
+ * DictionaryTrie behind the cache.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "CachedDictionaryTrie.hpp"
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/**
+ * Caches the same small dictionary as SmallDictTrieFixture
+ */
+class SmallCachedDictTrieFixture : public ::testing::Test {
+  protected:
+    DictionaryTrie dict;
+    CachedDictionaryTrie cached;
+
+  public:
+    SmallCachedDictTrieFixture() : cached(dict, 4) {
+        vector<string> inputs{"exist",    "a",  "ant",     "and",
+                              "octorber", "an", "ancester"};
+        vector<int> freqs{200, 1000, 400, 400, 300, 800, 0};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            dict.insert(inputs[i], freqs[i]);
+        }
+    }
+};
+
+TEST_F(SmallCachedDictTrieFixture, SMALL_HIT_TEST) {
+    // expect the first query to miss and the same query to hit
+    vector<string> vtr1{"an", "and", "ant"};
+    EXPECT_EQ(cached.predictCompletions("an", 3), vtr1);
+    EXPECT_EQ(cached.predictCompletions("an", 3), vtr1);
+    EXPECT_EQ(cached.misses(), 1);
+    EXPECT_EQ(cached.hits(), 1);
+    // expect a smaller k to be answered by the cached larger k
+    vector<string> vtr2{"an"};
+    EXPECT_EQ(cached.predictCompletions("an", 1), vtr2);
+    EXPECT_EQ(cached.hits(), 2);
+    // expect a larger k to miss, unless the cached result has every match
+    EXPECT_EQ(cached.predictCompletions("an", 4),
+              dict.predictCompletions("an", 4));
+    EXPECT_EQ(cached.misses(), 2);
+    EXPECT_EQ(cached.predictCompletions("an", 10),
+              dict.predictCompletions("an", 10));
+    EXPECT_EQ(cached.predictCompletions("an", 20),
+              dict.predictCompletions("an", 20));
+    EXPECT_EQ(cached.misses(), 3);
+    EXPECT_EQ(cached.hits(), 3);
+    // expect completions and underscores to be cached apart
+    vector<string> vtr3{"a"};
+    EXPECT_EQ(cached.predictUnderscores("a", 5), vtr3);
+    EXPECT_EQ(cached.predictCompletions("a", 1), vtr3);
+    EXPECT_EQ(cached.misses(), 5);
+    EXPECT_EQ(cached.size(), 3);
+}
+
+TEST_F(SmallCachedDictTrieFixture, SMALL_EVICT_TEST) {
+    // expect the least recently used result to be evicted
+    for (string prefix : {"a", "an", "e", "o"}) {
+        cached.predictCompletions(prefix, 2);
+    }
+    cached.predictCompletions("a", 2);
+    cached.predictCompletions("ex", 2);
+    EXPECT_EQ(cached.size(), 4);
+    EXPECT_EQ(cached.misses(), 5);
+    // "an" was the least recently used
+    cached.predictCompletions("an", 2);
+    EXPECT_EQ(cached.misses(), 6);
+    cached.predictCompletions("a", 2);
+    EXPECT_EQ(cached.hits(), 2);
+    cached.clear();
+    EXPECT_EQ(cached.size(), 0);
+}
+
+TEST_F(SmallCachedDictTrieFixture, SMALL_INSERT_TEST) {
+    CachedDictionaryTrie big(dict, 16);
+    vector<string> prefixes{"", "a", "an", "ant"};
+    for (const string& prefix : prefixes) {
+        big.predictCompletions(prefix, 2);
+    }
+    big.predictUnderscores("an_", 2);
+    big.predictUnderscores("___", 2);
+    big.predictUnderscores("e____", 2);
+    big.predictUnderscores("a__", 2);
+    EXPECT_EQ(big.size(), 8);
+
+    // expect a failed insert to keep every result
+    EXPECT_FALSE(big.insert("ant", 10000));
+    EXPECT_EQ(big.size(), 8);
+    // expect the results that could hold the new word to be dropped, so
+    //      that the next queries see it
+    EXPECT_TRUE(big.insert("any", 5000));
+    EXPECT_EQ(big.size(), 2);
+    vector<string> vtr1{"any", "and"};
+    EXPECT_EQ(big.predictUnderscores("an_", 2), vtr1);
+    EXPECT_EQ(big.predictUnderscores("___", 2), vtr1);
+    EXPECT_EQ(big.predictUnderscores("a__", 2), vtr1);
+    vector<string> vtr2{"any", "a"};
+    EXPECT_EQ(big.predictCompletions("", 2), vtr2);
+    EXPECT_EQ(big.predictCompletions("a", 2), vtr2);
+    // expect the other results to stay cached
+    size_t hits = big.hits();
+    vector<string> vtr3{"ant"};
+    EXPECT_EQ(big.predictCompletions("ant", 1), vtr3);
+    vector<string> vtr4{"exist"};
+    EXPECT_EQ(big.predictUnderscores("e____", 1), vtr4);
+    EXPECT_EQ(big.hits(), hits + 2);
+}
+
+TEST_F(SmallCachedDictTrieFixture, SMALL_UPSERT_TEST) {
+    CachedDictionaryTrie big(dict, 16);
+    big.predictCompletions("an", 2);
+    big.predictCompletions("e", 2);
+    big.predictUnderscores("a__", 2);
+    big.predictUnderscores("e____", 2);
+    EXPECT_EQ(big.size(), 4);
+
+    // expect a change of frequency to drop the results that hold the
+    //      word, like an insert
+    EXPECT_FALSE(big.upsert("ant", 10000));
+    EXPECT_EQ(big.size(), 2);
+    vector<string> vtr1{"ant", "an"};
+    EXPECT_EQ(big.predictCompletions("an", 2), vtr1);
+    vector<string> vtr2{"ant", "and"};
+    EXPECT_EQ(big.predictUnderscores("a__", 2), vtr2);
+    EXPECT_TRUE(big.addFrequency("ant", -10000));
+    vector<string> vtr3{"an", "and"};
+    EXPECT_EQ(big.predictCompletions("an", 2), vtr3);
+    EXPECT_EQ(big.size(), 3);
+    // expect a missing word to keep every result
+    EXPECT_FALSE(big.addFrequency("any", 1));
+    EXPECT_EQ(big.size(), 3);
+    // expect a batch to drop every result
+    vector<pair<string_view, long long>> deltas{{"exist", 5}, {"any", 1}};
+    EXPECT_EQ(big.addFrequencies(deltas), 1);
+    EXPECT_EQ(big.size(), 0);
+}
+
+TEST_F(SmallCachedDictTrieFixture, SMALL_ERASE_TEST) {
+    CachedDictionaryTrie big(dict, 16);
+    big.predictCompletions("an", 2);
+    big.predictCompletions("e", 2);
+    big.predictUnderscores("an_", 2);
+    EXPECT_EQ(big.size(), 3);
+
+    // expect an erase to drop the results that held the word
+    EXPECT_FALSE(big.erase("any"));
+    EXPECT_EQ(big.size(), 3);
+    EXPECT_TRUE(big.erase("and"));
+    EXPECT_EQ(big.size(), 1);
+    vector<string> vtr1{"an", "ant"};
+    EXPECT_EQ(big.predictCompletions("an", 2), vtr1);
+    EXPECT_EQ(big.predictUnderscores("an_", 2), vector<string>{"ant"});
+    // expect a batch to drop every result
+    vector<string_view> texts{"ant", "exist"};
+    EXPECT_EQ(big.eraseAll(texts), 2);
+    EXPECT_EQ(big.size(), 0);
+    EXPECT_EQ(big.predictUnderscores("an_", 2).size(), 0);
+}
+
+/* Concurrent queries and inserts test */
+TEST(CachedDictTrieTests, CONCURRENT_TEST) {
+    DictionaryTrie dict;
+    CachedDictionaryTrie cached(dict, 16);
+    vector<string> words;
+    for (char c1 = 'a'; c1 <= 'h'; c1++) {
+        for (char c2 = 'a'; c2 <= 'h'; c2++) {
+            words.push_back(string{c1, c2});
+        }
+    }
+
+    // expect queries running next to inserts to neither crash nor leave
+    //      stale results behind
+    vector<thread> threads;
+    threads.emplace_back([&]() {
+        for (size_t i = 0; i < words.size(); i++) {
+            cached.insert(words[i], i);
+        }
+    });
+    for (int t = 0; t < 3; t++) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 200; round++) {
+                for (char c = 'a'; c <= 'h'; c++) {
+                    cached.predictCompletions(string(1, c), 3);
+                    cached.predictUnderscores(string{'_', c}, 3);
+                }
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    for (char c = 'a'; c <= 'h'; c++) {
+        EXPECT_EQ(cached.predictCompletions(string(1, c), 3),
+                  dict.predictCompletions(string(1, c), 3));
+        EXPECT_EQ(cached.predictUnderscores(string{'_', c}, 3),
+                  dict.predictUnderscores(string{'_', c}, 3));
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * This File tests all the methods implemented in
+ * CompletionSession, by comparing the completions of a typed
+ * prefix with predictCompletions of the same prefix.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "CompletionSession.hpp"
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* Empty test */
+TEST(CompletionSessionTests, EMPTY_TEST) {
+    DictionaryTrie dict;
+    CompletionSession session(dict);
+    EXPECT_FALSE(session.alive());
+    EXPECT_EQ(session.complete(4).size(), 0);
+    // expect a word inserted during the session to be seen
+    session.push('a');
+    EXPECT_FALSE(session.alive());
+    dict.insert("ab", 10);
+    EXPECT_TRUE(session.alive());
+    vector<string> vtr1{"ab"};
+    EXPECT_EQ(session.complete(4), vtr1);
+}
+
+/**
+ * Types into the same small dictionary as SmallDictTrieFixture
+ */
+class SmallCompletionSessionFixture : public ::testing::Test {
+  protected:
+    DictionaryTrie dict;
+
+  public:
+    SmallCompletionSessionFixture() {
+        vector<string> inputs{"exist",    "a",  "ant",     "and",
+                              "octorber", "an", "ancester"};
+        vector<int> freqs{200, 1000, 400, 400, 300, 800, 0};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            dict.insert(inputs[i], freqs[i]);
+        }
+    }
+};
+
+TEST_F(SmallCompletionSessionFixture, SMALL_TYPING_TEST) {
+    // expect every typed prefix to complete like predictCompletions
+    CompletionSession session(dict);
+    EXPECT_EQ(session.complete(4), dict.predictCompletions("", 4));
+    for (char letter : string("ancester")) {
+        session.push(letter);
+        EXPECT_TRUE(session.alive());
+        EXPECT_EQ(session.complete(3),
+                  dict.predictCompletions(session.prefix(), 3));
+    }
+    // expect backspaces to go back to the shorter prefixes
+    for (int i = 0; i < 6; i++) {
+        session.pop();
+    }
+    EXPECT_EQ(session.prefix(), "an");
+    vector<string> vtr1{"an", "and", "ant"};
+    EXPECT_EQ(session.complete(3), vtr1);
+    session.reset();
+    EXPECT_EQ(session.prefix(), "");
+    // expect a backspace on the empty prefix to do nothing
+    session.pop();
+    EXPECT_EQ(session.complete(1), dict.predictCompletions("", 1));
+}
+
+TEST_F(SmallCompletionSessionFixture, SMALL_DEAD_PREFIX_TEST) {
+    CompletionSession session(dict);
+    for (char letter : string("exz")) {
+        session.push(letter);
+    }
+    // expect the prefix to be dead from the letter that leaves the trie on
+    EXPECT_FALSE(session.alive());
+    session.push('q');
+    EXPECT_FALSE(session.alive());
+    EXPECT_EQ(session.complete(4).size(), 0);
+    session.pop();
+    session.pop();
+    EXPECT_TRUE(session.alive());
+    vector<string> vtr1{"exist"};
+    EXPECT_EQ(session.complete(4), vtr1);
+
+    // expect an insert to bring a dead prefix back
+    session.push('z');
+    session.push('q');
+    EXPECT_FALSE(session.alive());
+    dict.insert("exzqy", 50);
+    EXPECT_TRUE(session.alive());
+    vector<string> vtr2{"exzqy"};
+    EXPECT_EQ(session.complete(4), vtr2);
+}
+
+TEST_F(SmallCompletionSessionFixture, SMALL_ERASE_TEST) {
+    CompletionSession session(dict);
+    for (char letter : string("ance")) {
+        session.push(letter);
+    }
+    EXPECT_TRUE(session.alive());
+
+    // expect an erase to kill a prefix whose nodes went away, and an
+    //      insert that reuses them to bring it back
+    EXPECT_TRUE(dict.erase("ancester"));
+    EXPECT_FALSE(session.alive());
+    EXPECT_EQ(session.complete(4).size(), 0);
+    dict.insert("anchor", 10);
+    dict.insert("ancestor", 20);
+    EXPECT_TRUE(session.alive());
+    vector<string> vtr1{"ancestor"};
+    EXPECT_EQ(session.complete(4), vtr1);
+    session.pop();
+    vector<string> vtr2{"ancestor", "anchor"};
+    EXPECT_EQ(session.complete(4), vtr2);
+}
@@ -10,10 +10,17 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <climits>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <regex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -96,6 +103,57 @@ TEST_F(SmallDictTrieFixture, SMALL_INSERT_TEST) {
     EXPECT_FALSE(dict.insert("exist", 100));
 }
 
+TEST_F(SmallDictTrieFixture, SMALL_UPSERT_TEST) {
+    // expect upsert to change the frequency of a word already in dict
+    EXPECT_FALSE(dict.upsert("ancester", 5000));
+    vector<string> vtr1{"ancester", "an"};
+    EXPECT_EQ(dict.predictCompletions("an", 2), vtr1);
+    EXPECT_EQ(dict.predictCompletions("", 1), vector<string>{"ancester"});
+    // expect a drop to let the next best words through again
+    EXPECT_TRUE(dict.addFrequency("ancester", -4990));
+    vector<string> vtr2{"an", "and", "ant", "ancester"};
+    EXPECT_EQ(dict.predictCompletions("an", 4), vtr2);
+    EXPECT_EQ(dict.predictCompletions("", 1), vector<string>{"a"});
+    // expect the frequency to stay between 0 and UINT_MAX
+    EXPECT_TRUE(dict.addFrequency("a", -2000));
+    EXPECT_EQ(dict.wordFrequency(dict.wordId("a")), 0);
+    EXPECT_TRUE(dict.addFrequency("exist", 1LL << 40));
+    EXPECT_EQ(dict.wordFrequency(dict.wordId("exist")), UINT_MAX);
+    // expect a missing word to be inserted by upsert only
+    EXPECT_FALSE(dict.addFrequency("any", 1));
+    EXPECT_FALSE(dict.find("any"));
+    EXPECT_TRUE(dict.upsert("any", 900));
+    vector<string> vtr3{"any", "an"};
+    EXPECT_EQ(dict.predictCompletions("an", 2), vtr3);
+    EXPECT_FALSE(dict.upsert("", 1));
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_ERASE_TEST) {
+    // expect erase to remove a word and keep the words around it
+    EXPECT_TRUE(dict.erase("an"));
+    EXPECT_FALSE(dict.find("an"));
+    EXPECT_TRUE(dict.find("and"));
+    EXPECT_TRUE(dict.find("a"));
+    EXPECT_FALSE(dict.erase("an"));
+    EXPECT_FALSE(dict.erase("anc"));
+    EXPECT_FALSE(dict.erase(""));
+    EXPECT_EQ(dict.wordCount(), 6);
+    vector<string> vtr1{"and", "ant", "ancester"};
+    EXPECT_EQ(dict.predictCompletions("an", 5), vtr1);
+    // expect the letters only "ancester" used to go, and maxFreq to drop
+    size_t numNodes = dict.nodeCount();
+    EXPECT_TRUE(dict.erase("ancester"));
+    EXPECT_EQ(dict.nodeCount(), numNodes - 6);
+    EXPECT_TRUE(dict.erase("a"));
+    EXPECT_EQ(dict.predictCompletions("", 1), vector<string>{"and"});
+    // expect an erased word to come back with a new id
+    uint32_t id = dict.wordId("exist");
+    EXPECT_TRUE(dict.erase("exist"));
+    EXPECT_TRUE(dict.insert("exist", 5000));
+    EXPECT_NE(dict.wordId("exist"), id);
+    EXPECT_EQ(dict.predictCompletions("", 1), vector<string>{"exist"});
+}
+
 TEST_F(SmallDictTrieFixture, SMALL_PREDICT_COMPLETIONS_TEST) {
     // expect empty vector when no completion exists
     EXPECT_EQ(dict.predictCompletions("z", 10).size(), 0);
@@ -148,6 +206,917 @@ TEST_F(SmallDictTrieFixture, SMALL_PREDICT_UNDERSCORES_TEST) {
     EXPECT_EQ(dict.predictUnderscores("a", 10), vtr4);
 }
 
+TEST_F(SmallDictTrieFixture, SMALL_PREDICT_PATTERN_TEST) {
+    // expect empty vector for a malformed pattern or no match
+    EXPECT_EQ(dict.predictPattern("a[nt", 4).size(), 0);
+    EXPECT_EQ(dict.predictPattern("?a", 4).size(), 0);
+    EXPECT_EQ(dict.predictPattern("", 4).size(), 0);
+    EXPECT_EQ(dict.predictPattern("z*", 4).size(), 0);
+    EXPECT_EQ(dict.predictPattern("an*", 0).size(), 0);
+
+    // expect * to match any run of letters, the empty one too
+    vector<string> vtr1{"a", "an", "and", "ant", "ancester"};
+    EXPECT_EQ(dict.predictPattern("a*", 10), vtr1);
+    EXPECT_EQ(dict.predictPattern("a*", 10), dict.predictCompletions("a", 10));
+    vector<string> vtr2{"octorber", "ancester"};
+    EXPECT_EQ(dict.predictPattern("*er", 10), vtr2);
+    vector<string> vtr3{"a", "an", "and", "ant", "octorber"};
+    EXPECT_EQ(dict.predictPattern("*", 5), vtr3);
+    // expect _ to match exactly one letter, like predictUnderscores
+    EXPECT_EQ(dict.predictPattern("_x_s_", 4),
+              dict.predictUnderscores("_x_s_", 4));
+    // expect a class to match one of its letters
+    vector<string> vtr4{"and", "ant"};
+    EXPECT_EQ(dict.predictPattern("an[a-z]", 4), vtr4);
+    vector<string> vtr5{"ant"};
+    EXPECT_EQ(dict.predictPattern("an[^d]", 4), vtr5);
+    EXPECT_EQ(dict.predictPattern("[aeiou]n[st]", 4), vtr5);
+    // expect ? to make the letter before it optional
+    vector<string> vtr6{"a", "an", "and"};
+    EXPECT_EQ(dict.predictPattern("an?d?", 4), vtr6);
+    // expect a backslash to match the next character itself
+    EXPECT_EQ(dict.predictPattern("an\\*", 4).size(), 0);
+    EXPECT_TRUE(dict.insert("a*b", 5));
+    vector<string> vtr7{"a*b"};
+    EXPECT_EQ(dict.predictPattern("a\\*b", 4), vtr7);
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_PREDICT_FUZZY_TEST) {
+    // expect no typo to complete like predictCompletions
+    EXPECT_EQ(dict.predictFuzzy("an", 0, 10),
+              dict.predictCompletions("an", 10));
+    EXPECT_EQ(dict.predictFuzzy("an", 1, 0).size(), 0);
+    EXPECT_EQ(dict.predictFuzzy("zz", 1, 10).size(), 0);
+    // expect a replaced, missing, extra or swapped letter to cost one edit
+    vector<string> vtr1{"exist"};
+    EXPECT_EQ(dict.predictFuzzy("exost", 1, 10), vtr1);
+    EXPECT_EQ(dict.predictFuzzy("exst", 1, 10), vtr1);
+    EXPECT_EQ(dict.predictFuzzy("exxist", 1, 10), vtr1);
+    EXPECT_EQ(dict.predictFuzzy("eixst", 1, 10), vtr1);
+    EXPECT_EQ(dict.predictFuzzy("eixts", 1, 10).size(), 0);
+    EXPECT_EQ(dict.predictFuzzy("eixts", 2, 10), vtr1);
+    // expect fewer edits first, then higher frequency
+    vector<string> vtr2{"ancester", "an", "and", "ant"};
+    EXPECT_EQ(dict.predictFuzzy("anc", 1, 5), vtr2);
+    vector<string> vtr3{"octorber"};
+    EXPECT_EQ(dict.predictFuzzy("oc", 1, 5), vtr3);
+    vector<string> vtr4{"octorber", "a", "an", "and", "ant"};
+    EXPECT_EQ(dict.predictFuzzy("oc", 2, 5), vtr4);
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_PRECOMPUTE_TEST) {
+    // a copy of the fixture without precomputed lists to compare with
+    DictionaryTrie plain;
+    vector<string> inputs{"exist",    "a",  "ant",     "and",
+                          "octorber", "an", "ancester"};
+    vector<int> freqs{200, 1000, 400, 400, 300, 800, 0};
+    for (size_t i = 0; i < inputs.size(); i++) {
+        plain.insert(inputs[i], freqs[i]);
+    }
+    vector<string> prefixes{"", "a", "an", "anc", "ance", "e", "o", "z"};
+
+    dict.precomputeCompletions(3, 2);
+    EXPECT_GT(dict.precomputedMemoryUsage(), 0);
+    // expect the same completions with and without the lists, for k both
+    //      within and beyond the precomputed 3
+    for (const string& prefix : prefixes) {
+        for (unsigned int k = 0; k <= 5; k++) {
+            EXPECT_EQ(dict.predictCompletions(prefix, k),
+                      plain.predictCompletions(prefix, k));
+        }
+    }
+
+    // expect inserts after the precompute to keep the lists correct
+    vector<string> newWords{"ant farm", "be", "ax", "anchor", "e"};
+    vector<int> newFreqs{5000, 50, 1000, 400, 900};
+    for (size_t i = 0; i < newWords.size(); i++) {
+        dict.insert(newWords[i], newFreqs[i]);
+        plain.insert(newWords[i], newFreqs[i]);
+    }
+    prefixes.push_back("b");
+    prefixes.push_back("ax");
+    for (const string& prefix : prefixes) {
+        for (unsigned int k = 0; k <= 5; k++) {
+            EXPECT_EQ(dict.predictCompletions(prefix, k),
+                      plain.predictCompletions(prefix, k));
+        }
+    }
+
+    // expect no lists to be left after k = 0
+    dict.precomputeCompletions(0, 2);
+    vector<string> vtr1{"ant farm", "a", "ax"};
+    EXPECT_EQ(dict.predictCompletions("", 3), vtr1);
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_BEST_FIRST_TEST) {
+    // add words of equal frequency, so that ties have to be broken
+    //      alphabetically
+    vector<string> ties{"anta", "antb", "ab", "ex", "exits", "ant farm"};
+    for (const string& word : ties) {
+        dict.insert(word, 400);
+    }
+    vector<string> prefixes{"", "a", "an", "ant", "anc", "e", "ex", "z"};
+    vector<vector<string>> expected;
+    for (const string& prefix : prefixes) {
+        for (unsigned int k = 0; k <= 12; k++) {
+            expected.push_back(dict.predictCompletions(prefix, k));
+        }
+    }
+
+    // expect the best-first search to give the same completions
+    dict.setTopKSearch(DictionaryTrie::BEST_FIRST);
+    int i = 0;
+    for (const string& prefix : prefixes) {
+        for (unsigned int k = 0; k <= 12; k++) {
+            EXPECT_EQ(dict.predictCompletions(prefix, k), expected[i++]);
+        }
+    }
+    vector<string> vtr1{"a", "an", "ab", "and", "ant"};
+    EXPECT_EQ(dict.predictCompletions("a", 5), vtr1);
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_REUSED_LIST_TEST) {
+    // expect a reused list to get the same completions as a new one, with
+    //      nothing left over from the longer lists before it
+    vector<string> prefixes{"", "a", "an", "ant", "anc", "e", "z", "an"};
+    for (DictionaryTrie::TopKSearch search :
+         {DictionaryTrie::DEPTH_FIRST, DictionaryTrie::BEST_FIRST}) {
+        dict.setTopKSearch(search);
+        vector<string> results{"stale", "results", "from", "a", "caller"};
+        for (const string& prefix : prefixes) {
+            for (unsigned int k : {10, 2, 0, 1, 5}) {
+                dict.predictCompletions(prefix, k, results);
+                EXPECT_EQ(results, dict.predictCompletions(prefix, k));
+            }
+        }
+    }
+    vector<string> vtr1{"a", "an", "and"};
+    vector<string> results(7, "a word longer than the small string buffer");
+    dict.predictCompletions("a", 3, results);
+    EXPECT_EQ(results, vtr1);
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_WORD_ID_TEST) {
+    // expect the words to be numbered 1, 2, ... in insertion order
+    EXPECT_EQ(dict.wordCount(), 7);
+    EXPECT_EQ(dict.wordId("exist"), 1);
+    EXPECT_EQ(dict.wordId("ancester"), 7);
+    EXPECT_EQ(dict.wordId("anc"), 0);
+    EXPECT_EQ(dict.wordId(""), 0);
+    EXPECT_EQ(dict.wordText(4), "and");
+    EXPECT_EQ(dict.wordFrequency(6), 800);
+    // expect a failed insert to take no id, and a new word the next one
+    EXPECT_FALSE(dict.insert("and", 10));
+    EXPECT_TRUE(dict.insert("any", 600));
+    EXPECT_EQ(dict.wordId("any"), 8);
+
+    // expect the ids of the completions to name the same words, with both
+    //      searches and from the precomputed lists
+    vector<uint32_t> ids{1, 2};
+    vector<string> prefixes{"", "a", "an", "anc", "ex", "z"};
+    for (int round = 0; round < 3; round++) {
+        if (round == 1) {
+            dict.setTopKSearch(DictionaryTrie::BEST_FIRST);
+        } else if (round == 2) {
+            dict.precomputeCompletions(3, 2);
+        }
+        for (const string& prefix : prefixes) {
+            for (unsigned int k : {0, 1, 3, 10}) {
+                dict.predictCompletionIds(prefix, k, ids);
+                vector<string> texts;
+                for (uint32_t id : ids) {
+                    texts.push_back(string(dict.wordText(id)));
+                }
+                EXPECT_EQ(texts, dict.predictCompletions(prefix, k));
+            }
+        }
+    }
+
+    // expect the words to be written in the format of the dictionary file
+    dict.predictCompletionIds("an", 3, ids);
+    ostringstream out;
+    Utils::writeWords(out, dict, ids);
+    EXPECT_EQ(out.str(), "800 an\n600 any\n400 and\n");
+}
+
+TEST_F(SmallDictTrieFixture, SMALL_BATCH_TEST) {
+    vector<DictionaryTrie::BatchQuery> queries{
+        {"", 4, false},  {"an", 3, false}, {"z", 2, false},
+        {"an_", 1, true}, {"___", 5, true}, {"e", 0, false}};
+    for (int i = 0; i < 40; i++) {
+        queries.push_back({string(i % 3, 'a'), (unsigned int)i % 5, false});
+    }
+
+    // expect every thread count, even more than queries, to give the
+    //      answers of the single queries
+    for (unsigned int numThreads : {1u, 2u, 3u, 64u}) {
+        vector<vector<string>> results;
+        dict.predictCompletionsBatch(queries, results, numThreads);
+        ASSERT_EQ(results.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (queries[i].underscores) {
+                EXPECT_EQ(results[i],
+                          dict.predictUnderscores(queries[i].text,
+                                                  queries[i].numCompletions));
+            } else {
+                EXPECT_EQ(results[i],
+                          dict.predictCompletions(queries[i].text,
+                                                  queries[i].numCompletions));
+            }
+        }
+    }
+
+    // expect an empty batch to give no results
+    vector<vector<string>> results;
+    dict.predictCompletionsBatch(vector<DictionaryTrie::BatchQuery>(), results,
+                                 4);
+    EXPECT_EQ(results.size(), 0);
+}
+
+/* Wildcard pattern test */
+TEST(DictTrieTests, PATTERN_TEST) {
+    // a dictionary of short words over a small alphabet, with few distinct
+    //      frequencies so that many ties have to be broken alphabetically
+    DictionaryTrie dict;
+    vector<pair<string, unsigned int>> entries;
+    unsigned int seed = 12345;
+    for (int i = 0; i < 3000; i++) {
+        seed = seed * 1103515245 + 12345;
+        string word(1 + (seed >> 16) % 6, 'a');
+        for (char& letter : word) {
+            seed = seed * 1103515245 + 12345;
+            letter = 'a' + (seed >> 16) % 4;
+        }
+        if (dict.insert(word, (seed >> 8) % 7)) {
+            entries.push_back({word, (seed >> 8) % 7});
+        }
+    }
+
+    // expect the pruned matcher to give the best k matches found by
+    //      checking every word
+    vector<string> patterns{"_",    "__",   "___",   "____",  "______",
+                            "a_",   "_a",   "a__d",  "_b_c_", "c____",
+                            "dddd", "abca", "_______"};
+    for (const string& pattern : patterns) {
+        vector<pair<unsigned int, string>> matches;
+        for (const pair<string, unsigned int>& e : entries) {
+            bool match = e.first.length() == pattern.length();
+            for (size_t i = 0; match && i < pattern.length(); i++) {
+                match = pattern[i] == '_' || pattern[i] == e.first[i];
+            }
+            if (match) {
+                matches.push_back({e.second, e.first});
+            }
+        }
+        sort(matches.begin(), matches.end(),
+             [](const pair<unsigned int, string>& m1,
+                const pair<unsigned int, string>& m2) {
+                 if (m1.first != m2.first) {
+                     return m1.first > m2.first;
+                 }
+                 return m1.second < m2.second;
+             });
+        for (unsigned int k : {1, 3, 10, 50, 5000}) {
+            vector<string> expected;
+            for (size_t i = 0; i < matches.size() && i < k; i++) {
+                expected.push_back(matches[i].second);
+            }
+            EXPECT_EQ(dict.predictUnderscores(pattern, k), expected);
+        }
+    }
+}
+
+/* Pattern automaton test */
+TEST(DictTrieTests, PATTERN_AUTOMATON_TEST) {
+    DictionaryTrie dict;
+    vector<pair<string, unsigned int>> entries;
+    unsigned int seed = 2024;
+    for (int i = 0; i < 3000; i++) {
+        seed = seed * 1103515245 + 12345;
+        string word(1 + (seed >> 16) % 7, 'a');
+        for (char& letter : word) {
+            seed = seed * 1103515245 + 12345;
+            letter = 'a' + (seed >> 16) % 4;
+        }
+        if (dict.insert(word, (seed >> 8) % 7)) {
+            entries.push_back({word, (seed >> 8) % 7});
+        }
+    }
+
+    // expect the automaton walk to give the best k matches of the same
+    //      pattern written as a regular expression
+    vector<pair<string, string>> patterns{
+        {"*", ".*"},
+        {"a*", "a.*"},
+        {"*d", ".*d"},
+        {"*ab*", ".*ab.*"},
+        {"_*c_", "..*c."},
+        {"[ab]*[cd]", "[ab].*[cd]"},
+        {"[^a]_?[b-c]*", "[^a].?[b-c].*"},
+        {"a?b?c?d?", "a?b?c?d?"},
+        {"d*a*d", "d.*a.*d"},
+        {"__[c-d]__", "..[c-d].."},
+        {"*a*a*a*a", ".*a.*a.*a.*a"}};
+    for (const pair<string, string>& pattern : patterns) {
+        regex expression(pattern.second);
+        vector<pair<unsigned int, string>> matches;
+        for (const pair<string, unsigned int>& e : entries) {
+            if (regex_match(e.first, expression)) {
+                matches.push_back({e.second, e.first});
+            }
+        }
+        sort(matches.begin(), matches.end(),
+             [](const pair<unsigned int, string>& m1,
+                const pair<unsigned int, string>& m2) {
+                 if (m1.first != m2.first) {
+                     return m1.first > m2.first;
+                 }
+                 return m1.second < m2.second;
+             });
+        for (unsigned int k : {1, 3, 10, 50, 5000}) {
+            vector<string> expected;
+            for (size_t i = 0; i < matches.size() && i < k; i++) {
+                expected.push_back(matches[i].second);
+            }
+            EXPECT_EQ(dict.predictPattern(pattern.first, k), expected);
+        }
+    }
+}
+
+/* Fuzzy completion test */
+TEST(DictTrieTests, FUZZY_TEST) {
+    DictionaryTrie dict;
+    vector<pair<string, unsigned int>> entries;
+    unsigned int seed = 777;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1103515245 + 12345;
+        string word(1 + (seed >> 16) % 7, 'a');
+        for (char& letter : word) {
+            seed = seed * 1103515245 + 12345;
+            letter = 'a' + (seed >> 16) % 5;
+        }
+        if (dict.insert(word, (seed >> 8) % 7)) {
+            entries.push_back({word, (seed >> 8) % 7});
+        }
+    }
+
+    // expect the best k words by their fewest edits to a prefix of them,
+    //      then by frequency, as found by checking every word
+    vector<string> prefixes{"", "a", "ba", "abc", "edcb", "aabbc", "ecdab"};
+    for (const string& prefix : prefixes) {
+        size_t width = prefix.length() + 1;
+        vector<tuple<unsigned int, unsigned int, string>> distances;
+        for (const pair<string, unsigned int>& e : entries) {
+            // the rows of edit distances along the word
+            const string& word = e.first;
+            vector<unsigned int> rows((word.length() + 1) * width);
+            unsigned int fewest = prefix.length();
+            for (size_t j = 0; j < width; j++) {
+                rows[j] = j;
+            }
+            for (size_t i = 1; i <= word.length(); i++) {
+                rows[i * width] = i;
+                for (size_t j = 1; j < width; j++) {
+                    unsigned int edits = min(
+                        {rows[(i - 1) * width + j] + 1,
+                         rows[i * width + j - 1] + 1,
+                         rows[(i - 1) * width + j - 1] +
+                             (prefix[j - 1] != word[i - 1])});
+                    if (i > 1 && j > 1 && prefix[j - 1] == word[i - 2] &&
+                        prefix[j - 2] == word[i - 1]) {
+                        edits = min(edits,
+                                    rows[(i - 2) * width + j - 2] + 1);
+                    }
+                    rows[i * width + j] = edits;
+                }
+                fewest = min(fewest, rows[i * width + width - 1]);
+            }
+            distances.push_back({fewest, e.second, word});
+        }
+        sort(distances.begin(), distances.end(),
+             [](const tuple<unsigned int, unsigned int, string>& d1,
+                const tuple<unsigned int, unsigned int, string>& d2) {
+                 if (get<0>(d1) != get<0>(d2)) {
+                     return get<0>(d1) < get<0>(d2);
+                 }
+                 if (get<1>(d1) != get<1>(d2)) {
+                     return get<1>(d1) > get<1>(d2);
+                 }
+                 return get<2>(d1) < get<2>(d2);
+             });
+        for (unsigned int maxEdits : {0, 1, 2}) {
+            for (unsigned int k : {1, 5, 20, 5000}) {
+                vector<string> expected;
+                for (size_t i = 0; i < distances.size() &&
+                                   expected.size() < k &&
+                                   get<0>(distances[i]) <= maxEdits;
+                     i++) {
+                    expected.push_back(get<2>(distances[i]));
+                }
+                EXPECT_EQ(dict.predictFuzzy(prefix, maxEdits, k), expected);
+            }
+        }
+    }
+}
+
+/* Pattern index test */
+TEST(DictTrieTests, PATTERN_INDEX_TEST) {
+    DictionaryTrie dict;
+    unsigned int seed = 54321;
+    for (int i = 0; i < 3000; i++) {
+        seed = seed * 1103515245 + 12345;
+        string word(1 + (seed >> 16) % 6, 'a');
+        for (char& letter : word) {
+            seed = seed * 1103515245 + 12345;
+            letter = 'a' + (seed >> 16) % 4;
+        }
+        dict.insert(word, (seed >> 8) % 7);
+    }
+    dict.buildPatternIndex();
+    EXPECT_GT(dict.patternIndexMemoryUsage(), 0);
+
+    // expect the posting lists and the planner to find the same words as
+    //      the trie walk
+    vector<string> patterns{"_",    "__",    "___",  "______", "a_",
+                            "_a",   "a__d",  "_b_c_", "c____", "dddd",
+                            "abca", "ab___", "_______"};
+    for (const string& pattern : patterns) {
+        for (unsigned int k : {1, 3, 10, 50, 5000}) {
+            dict.setPatternSearch(DictionaryTrie::TRIE_WALK);
+            vector<string> expected = dict.predictUnderscores(pattern, k);
+            dict.setPatternSearch(DictionaryTrie::POSTINGS);
+            EXPECT_EQ(dict.predictUnderscores(pattern, k), expected);
+            dict.setPatternSearch(DictionaryTrie::PLANNED);
+            EXPECT_EQ(dict.predictUnderscores(pattern, k), expected);
+        }
+    }
+
+    // expect an insert to leave the index out until it is built again
+    dict.setPatternSearch(DictionaryTrie::POSTINGS);
+    EXPECT_TRUE(dict.insert("eeee", 100));
+    EXPECT_EQ(dict.predictUnderscores("____", 1), vector<string>{"eeee"});
+    EXPECT_EQ(dict.predictUnderscores("_e__", 1), vector<string>{"eeee"});
+    dict.buildPatternIndex();
+    EXPECT_EQ(dict.predictUnderscores("____", 1), vector<string>{"eeee"});
+    EXPECT_EQ(dict.predictUnderscores("eee_", 5), vector<string>{"eeee"});
+}
+
+/* Frequency update test */
+
+/* return: the best k words of the prefix, found by checking every word */
+static vector<string> bestCompletions(const map<string, unsigned int>& dict,
+                                      const string& prefix, unsigned int k) {
+    vector<pair<unsigned int, string>> found;
+    for (const pair<const string, unsigned int>& e : dict) {
+        if (e.first.compare(0, prefix.length(), prefix) == 0) {
+            found.push_back({e.second, e.first});
+        }
+    }
+    sort(found.begin(), found.end(),
+         [](const pair<unsigned int, string>& f1,
+            const pair<unsigned int, string>& f2) {
+             if (f1.first != f2.first) {
+                 return f1.first > f2.first;
+             }
+             return f1.second < f2.second;
+         });
+    vector<string> words;
+    for (size_t i = 0; i < found.size() && words.size() < k; i++) {
+        words.push_back(found[i].second);
+    }
+    return words;
+}
+
+TEST(DictTrieTests, FREQUENCY_UPDATE_TEST) {
+    DictionaryTrie dict;
+    dict.precomputeCompletions(4, 2);
+    map<string, unsigned int> expected;
+    unsigned int seed = 2024;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    auto randomWord = [&random]() {
+        string word(1 + random(5), 'a');
+        for (char& letter : word) {
+            letter = 'a' + random(4);
+        }
+        return word;
+    };
+    for (int i = 0; i < 500; i++) {
+        string word = randomWord();
+        unsigned int freq = random(50);
+        if (dict.insert(word, freq)) {
+            expected[word] = freq;
+        }
+    }
+
+    auto best = [&expected](const string& prefix, unsigned int k) {
+        return bestCompletions(expected, prefix, k);
+    };
+    vector<string> prefixes{"", "a", "b", "cd", "aab", "dcba"};
+    auto check = [&]() {
+        for (const string& prefix : prefixes) {
+            for (unsigned int k : {1, 4, 10}) {
+                dict.setTopKSearch(DictionaryTrie::DEPTH_FIRST);
+                EXPECT_EQ(dict.predictCompletions(prefix, k), best(prefix, k));
+                dict.setTopKSearch(DictionaryTrie::BEST_FIRST);
+                EXPECT_EQ(dict.predictCompletions(prefix, k), best(prefix, k));
+            }
+        }
+    };
+
+    // expect raises and drops, one at a time, to keep maxFreq and the
+    //      precomputed lists right
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < 25; i++) {
+            string word = randomWord();
+            if (random(3) == 0) {
+                unsigned int freq = random(60);
+                EXPECT_EQ(dict.upsert(word, freq), expected.count(word) == 0);
+                expected[word] = freq;
+            } else {
+                long long delta = (long long)random(41) - 20;
+                bool found = expected.count(word) > 0;
+                EXPECT_EQ(dict.addFrequency(word, delta), found);
+                if (found) {
+                    expected[word] = max(0LL, expected[word] + delta);
+                }
+            }
+        }
+        check();
+    }
+
+    // expect a batch of changes to give the same words
+    vector<string> texts;
+    for (int i = 0; i < 3000; i++) {
+        texts.push_back(randomWord());
+    }
+    vector<pair<string_view, long long>> deltas;
+    size_t applied = 0;
+    for (const string& text : texts) {
+        long long delta = (long long)random(41) - 20;
+        deltas.push_back({text, delta});
+        if (expected.count(text) > 0) {
+            expected[text] = max(0LL, expected[text] + delta);
+            applied++;
+        }
+    }
+    EXPECT_EQ(dict.addFrequencies(deltas), applied);
+    check();
+
+    // expect the same with the words given by their ids, skipping the ids
+    //      that are not in dict
+    vector<pair<uint32_t, long long>> idDeltas{{0, 5}};
+    for (int i = 0; i < 1000; i++) {
+        uint32_t id = 1 + random(dict.wordCount());
+        long long delta = (long long)random(41) - 20;
+        idDeltas.push_back({id, delta});
+        string text(dict.wordText(id));
+        expected[text] = max(0LL, expected[text] + delta);
+    }
+    idDeltas.push_back({(uint32_t)dict.wordCount() + 1, 5});
+    EXPECT_EQ(dict.addFrequencies(idDeltas), 1000);
+    check();
+}
+
+/* Erase test */
+TEST(DictTrieTests, ERASE_TEST) {
+    DictionaryTrie dict;
+    dict.precomputeCompletions(3, 2);
+    map<string, unsigned int> expected;
+    unsigned int seed = 4242;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    auto randomWord = [&random]() {
+        string word(1 + random(5), 'a');
+        for (char& letter : word) {
+            letter = 'a' + random(4);
+        }
+        return word;
+    };
+
+    // expect the same words as the reference, and exactly one node per
+    //      letter of every prefix of a word, so no dead node is left over
+    vector<string> prefixes{"", "a", "c", "ab", "dd", "bca", "abcd"};
+    auto check = [&]() {
+        EXPECT_EQ(dict.wordCount(), expected.size());
+        set<string> seen;
+        for (const pair<const string, unsigned int>& e : expected) {
+            EXPECT_TRUE(dict.find(e.first));
+            for (size_t i = 1; i <= e.first.length(); i++) {
+                seen.insert(e.first.substr(0, i));
+            }
+        }
+        EXPECT_EQ(dict.nodeCount(), seen.size());
+        for (const string& prefix : prefixes) {
+            for (unsigned int k : {1, 3, 10}) {
+                vector<string> words = bestCompletions(expected, prefix, k);
+                dict.setTopKSearch(DictionaryTrie::DEPTH_FIRST);
+                EXPECT_EQ(dict.predictCompletions(prefix, k), words);
+                dict.setTopKSearch(DictionaryTrie::BEST_FIRST);
+                EXPECT_EQ(dict.predictCompletions(prefix, k), words);
+            }
+        }
+    };
+
+    for (int round = 0; round < 60; round++) {
+        for (int i = 0; i < 40; i++) {
+            string word = randomWord();
+            if (random(2) == 0) {
+                unsigned int freq = random(50);
+                bool inserted = expected.count(word) == 0;
+                EXPECT_EQ(dict.insert(word, freq), inserted);
+                if (inserted) {
+                    expected[word] = freq;
+                }
+            } else {
+                EXPECT_EQ(dict.erase(word), expected.erase(word) == 1);
+            }
+        }
+        check();
+    }
+
+    // expect a batch to erase the words found and skip the others
+    vector<string> texts;
+    for (int i = 0; i < 200; i++) {
+        texts.push_back(randomWord());
+    }
+    vector<string_view> batch(texts.begin(), texts.end());
+    size_t erased = 0;
+    for (const string& text : texts) {
+        erased += expected.erase(text);
+    }
+    EXPECT_EQ(dict.eraseAll(batch), erased);
+    check();
+
+    // expect the pattern index to leave the erased words out
+    dict.buildPatternIndex();
+    dict.setPatternSearch(DictionaryTrie::POSTINGS);
+    vector<string> matches = dict.predictUnderscores("___", 5000);
+    EXPECT_EQ(matches.size(), (size_t)count_if(
+        expected.begin(), expected.end(),
+        [](const pair<const string, unsigned int>& e) {
+            return e.first.length() == 3;
+        }));
+
+    // expect erasing every word to leave no node, and the trie to grow
+    //      back as before
+    size_t numNodes = dict.nodeCount();
+    for (const pair<const string, unsigned int>& e : expected) {
+        EXPECT_TRUE(dict.erase(e.first));
+    }
+    EXPECT_EQ(dict.nodeCount(), 0);
+    EXPECT_EQ(dict.wordCount(), 0);
+    EXPECT_TRUE(dict.predictCompletions("", 5).empty());
+    for (const pair<const string, unsigned int>& e : expected) {
+        EXPECT_TRUE(dict.insert(e.first, e.second));
+    }
+    EXPECT_EQ(dict.nodeCount(), numNodes);
+    check();
+}
+
+/* Root table test */
+TEST(DictTrieTests, ROOT_TABLE_TEST) {
+    DictionaryTrie dict;
+    map<string, unsigned int> expected;
+    unsigned int seed = 2718;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    auto randomWord = [&random]() {
+        string word(1 + random(4), 'a');
+        for (char& letter : word) {
+            letter = 'a' + random(4);
+        }
+        return word;
+    };
+
+    // expect the same answers with and without the root table, for words
+    //      and prefixes in the trie and out of it
+    vector<string> prefixes{"", "a", "d", "z", "ab", "dz", "bca", "abcd"};
+    auto check = [&]() {
+        for (bool table : {true, false}) {
+            dict.setRootTable(table);
+            for (int i = 0; i < 40; i++) {
+                string word = randomWord();
+                EXPECT_EQ(dict.find(word), expected.count(word) == 1);
+            }
+            EXPECT_FALSE(dict.find("z"));
+            EXPECT_FALSE(dict.find("az"));
+            for (const string& prefix : prefixes) {
+                EXPECT_EQ(dict.predictCompletions(prefix, 5),
+                          bestCompletions(expected, prefix, 5));
+            }
+        }
+    };
+
+    // every change runs with the table on or off at random, and must keep
+    //      the table right for the other
+    for (int round = 0; round < 60; round++) {
+        for (int i = 0; i < 30; i++) {
+            dict.setRootTable(random(2) == 0);
+            string word = randomWord();
+            unsigned int freq = random(1000);
+            switch (random(3)) {
+                case 0:
+                    EXPECT_EQ(dict.insert(word, freq),
+                              expected.count(word) == 0);
+                    expected.insert({word, freq});
+                    break;
+                case 1:
+                    dict.upsert(word, freq);
+                    expected[word] = freq;
+                    break;
+                default:
+                    EXPECT_EQ(dict.erase(word), expected.erase(word) == 1);
+            }
+        }
+        check();
+    }
+
+    // expect a batch erase and a bulk build to leave the table right
+    vector<string> texts;
+    for (int i = 0; i < 100; i++) {
+        texts.push_back(randomWord());
+    }
+    for (const string& text : texts) {
+        expected.erase(text);
+    }
+    dict.eraseAll(vector<string_view>(texts.begin(), texts.end()));
+    check();
+
+    DictionaryTrie built;
+    built.buildFromSorted(vector<pair<string, unsigned int>>(
+        expected.begin(), expected.end()));
+    for (const pair<const string, unsigned int>& e : expected) {
+        EXPECT_TRUE(built.find(e.first));
+    }
+    EXPECT_FALSE(built.find("z"));
+    EXPECT_TRUE(built.insert("zz", 5000));
+    EXPECT_TRUE(built.insert("aaaaa", 6000));
+    expected["zz"] = 5000;
+    expected["aaaaa"] = 6000;
+    for (const string& prefix : prefixes) {
+        EXPECT_EQ(built.predictCompletions(prefix, 5),
+                  bestCompletions(expected, prefix, 5));
+    }
+}
+
+/* Concurrent readers and one writer test */
+TEST(DictTrieTests, CONCURRENT_INSERT_TEST) {
+    // the words are "k" followed by their frequency, so a reader can tell
+    //      the frequency of every completion it gets. Short numbers are
+    //      prefixes of longer ones, so some inserts only mark a node.
+    const int NUM_WORDS = 20000;
+    vector<string> words;
+    for (int i = 0; i < NUM_WORDS; i++) {
+        words.push_back("k" + to_string((i * 7919) % NUM_WORDS + 1));
+    }
+    DictionaryTrie dict;
+    atomic<int> inserted(0);
+    atomic<bool> torn(false);
+
+    vector<thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&]() {
+            while (inserted.load() < NUM_WORDS) {
+                // expect every finished insert to be seen
+                int n = inserted.load();
+                if (n > 0 && !dict.find(words[n - 1])) {
+                    torn = true;
+                }
+                // expect completions with their frequency in place
+                vector<string> results = dict.predictCompletions("k", 10);
+                vector<string> matches = dict.predictUnderscores("k__", 10);
+                results.insert(results.end(), matches.begin(), matches.end());
+                for (size_t i = 1; i < results.size(); i++) {
+                    if (i != results.size() - matches.size() &&
+                        stoi(results[i].substr(1)) >=
+                            stoi(results[i - 1].substr(1))) {
+                        torn = true;
+                    }
+                }
+            }
+        });
+    }
+    for (int i = 0; i < NUM_WORDS; i++) {
+        dict.insert(words[i], stoi(words[i].substr(1)));
+        inserted.store(i + 1);
+    }
+    for (thread& t : readers) {
+        t.join();
+    }
+
+    EXPECT_FALSE(torn);
+    vector<string> vtr1{"k20000", "k19999", "k19998"};
+    EXPECT_EQ(dict.predictCompletions("k", 3), vtr1);
+    vector<string> vtr2{"k99", "k98"};
+    EXPECT_EQ(dict.predictUnderscores("k__", 2), vtr2);
+}
+
+/* Bulk build test */
+TEST(DictTrieTests, BULK_BUILD_TEST) {
+    // build the fixture dictionary in one bulk load, unsorted and with a
+    //      duplicate which must keep its first frequency
+    DictionaryTrie dict;
+    vector<pair<string, unsigned int>> entries{
+        {"exist", 200}, {"a", 1000},      {"ant", 400},   {"and", 400},
+        {"octorber", 300}, {"an", 800}, {"ancester", 0}, {"ant", 5000},
+        {"", 10}};
+    dict.buildFromSorted(entries);
+
+    EXPECT_TRUE(dict.find("ancester"));
+    EXPECT_TRUE(dict.find("an"));
+    EXPECT_FALSE(dict.find("anc"));
+    EXPECT_FALSE(dict.find(""));
+    vector<string> vtr1{"a", "an", "and", "ant"};
+    EXPECT_EQ(dict.predictCompletions("", 4), vtr1);
+    vector<string> vtr2{"an", "and", "ant", "ancester"};
+    EXPECT_EQ(dict.predictCompletions("an", 4), vtr2);
+    vector<string> vtr3{"and", "ant"};
+    EXPECT_EQ(dict.predictUnderscores("___", 5), vtr3);
+    // expect the balanced trie to be no deeper than the incremental one
+    DictionaryTrie incremental;
+    for (const pair<string, unsigned int>& e : entries) {
+        incremental.insert(e.first, e.second);
+    }
+    EXPECT_LE(dict.averageDepth(), incremental.averageDepth());
+    // expect the words to be numbered in alphabetical order, without the
+    //      duplicate and the empty word
+    EXPECT_EQ(dict.wordCount(), 7);
+    EXPECT_EQ(dict.wordId("a"), 1);
+    EXPECT_EQ(dict.wordId("octorber"), 7);
+    EXPECT_EQ(dict.wordFrequency(dict.wordId("ant")), 400);
+    // expect later inserts to work on a bulk built trie
+    EXPECT_TRUE(dict.insert("anchor", 900));
+    vector<string> vtr4{"anchor", "an"};
+    EXPECT_EQ(dict.predictCompletions("an", 2), vtr4);
+}
+
+/* Dictionary file parsing test */
+TEST(DictTrieTests, LOAD_DICT_TEST) {
+    // expect whitespace inside entries to collapse to single spaces, CRLF
+    //      line ends to be ignored and a "." word to end the entry
+    string file =
+        "10 a\n  20\tnew   york \r\n30 to . be\n+40 b\n\n50c\n60 last";
+    vector<string> words;
+    istringstream wordStream(file);
+    Utils::loadDict(words, wordStream);
+    vector<string> expected{"a", "new york", "to", "b", "c", "last"};
+    EXPECT_EQ(words, expected);
+
+    DictionaryTrie dict;
+    istringstream dictStream(file);
+    Utils::loadDict(dict, dictStream);
+    vector<string> vtr1{"last", "c", "b", "to", "new york", "a"};
+    EXPECT_EQ(dict.predictCompletions("", 10), vtr1);
+
+    // expect only the first numWords entries to be loaded
+    DictionaryTrie partial;
+    istringstream partialStream(file);
+    Utils::loadDict(partial, partialStream, 2);
+    vector<string> vtr2{"new york", "a"};
+    EXPECT_EQ(partial.predictCompletions("", 10), vtr2);
+}
+
+/* Parallel dictionary loading test */
+TEST(DictTrieTests, PARALLEL_LOAD_TEST) {
+    // an unsorted file with a duplicate far from its first entry, which
+    //      must keep its first frequency
+    string file =
+        "10 banana\n20 apple\n30 band\n40 cherry\n50 ban\n60 apricot\n"
+        "70 a\n80 zoo\n90 apple\n";
+    istringstream serialStream(file);
+    DictionaryTrie serial;
+    Utils::loadDictBulk(serial, serialStream);
+
+    // expect every thread count, even more than lines, to build the same
+    //      trie
+    for (unsigned int numThreads : {2u, 3u, 4u, 32u}) {
+        istringstream parallelStream(file);
+        DictionaryTrie parallel;
+        Utils::loadDictParallel(parallel, parallelStream, numThreads);
+        EXPECT_EQ(parallel.nodeCount(), serial.nodeCount());
+        EXPECT_EQ(parallel.predictCompletions("", 10),
+                  serial.predictCompletions("", 10));
+        vector<string> vtr1{"a", "apricot", "apple"};
+        EXPECT_EQ(parallel.predictCompletions("a", 10), vtr1);
+        vector<string> vtr2{"band"};
+        EXPECT_EQ(parallel.predictUnderscores("ba__", 10), vtr2);
+        EXPECT_FALSE(parallel.find("b"));
+    }
+
+    // expect an empty file to build an empty trie
+    istringstream emptyStream("");
+    DictionaryTrie empty;
+    Utils::loadDictParallel(empty, emptyStream, 4);
+    EXPECT_EQ(empty.nodeCount(), 0u);
+}
+
 /* Destructor test */
 TEST(DictTrieTests, DESTRUCTOR_TEST) {
     // test whether there's error in destructing empty trie
@@ -157,7 +1126,7 @@ TEST(DictTrieTests, DESTRUCTOR_TEST) {
     dict = new DictionaryTrie();
     vector<string> inputs{"exist", "a", "ant", "and"};
     vector<int> freqs{200, 1000, 400, 400};
-    for (int i = 0; i < inputs.size(); i++) {
+    for (size_t i = 0; i < inputs.size(); i++) {
         dict->insert(inputs[i], freqs[i]);
     }
     delete dict;
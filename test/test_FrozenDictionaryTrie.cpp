@@ -0,0 +1,176 @@
+/**
+ * This File tests all the methods implemented in
+ * FrozenDictionaryTrie, by comparing a frozen small dictionary
+ * with the DictionaryTrie it was frozen from.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* Empty test */
+TEST(FrozenDictTrieTests, EMPTY_TEST) {
+    DictionaryTrie dict;
+    FrozenDictionaryTrie frozen(dict);
+    EXPECT_FALSE(frozen.find("abrakadabra"));
+    EXPECT_EQ(frozen.predictCompletions("", 4).size(), 0);
+    EXPECT_EQ(frozen.predictUnderscores("_", 4).size(), 0);
+}
+
+/**
+ * Freezes the same small dictionary as SmallDictTrieFixture
+ */
+class SmallFrozenDictTrieFixture : public ::testing::Test {
+  protected:
+    DictionaryTrie dict;
+    FrozenDictionaryTrie* frozen;
+
+  public:
+    SmallFrozenDictTrieFixture() {
+        vector<string> inputs{"exist",    "a",  "ant",     "and",
+                              "octorber", "an", "ancester"};
+        vector<int> freqs{200, 1000, 400, 400, 300, 800, 0};
+        for (unsigned int i = 0; i < inputs.size(); i++) {
+            dict.insert(inputs[i], freqs[i]);
+        }
+        frozen = new FrozenDictionaryTrie(dict);
+    }
+    ~SmallFrozenDictTrieFixture() { delete frozen; }
+};
+
+TEST_F(SmallFrozenDictTrieFixture, SMALL_FIND_TEST) {
+    for (string word : {"exist", "and", "octorber", "a", "ancester"}) {
+        EXPECT_TRUE(frozen->find(word));
+    }
+    for (string word : {"not_exist", "", "anc", "exists", "b"}) {
+        EXPECT_FALSE(frozen->find(word));
+    }
+}
+
+TEST_F(SmallFrozenDictTrieFixture, SMALL_PREDICT_COMPLETIONS_TEST) {
+    // expect the same completions as the trie it was frozen from
+    for (string prefix : {"", "a", "an", "e", "z", "octorber", "anc"}) {
+        for (unsigned int k : {0, 1, 2, 4, 10}) {
+            EXPECT_EQ(frozen->predictCompletions(prefix, k),
+                      dict.predictCompletions(prefix, k));
+        }
+    }
+}
+
+TEST_F(SmallFrozenDictTrieFixture, SMALL_PREDICT_UNDERSCORES_TEST) {
+    // expect the same matches as the trie it was frozen from
+    for (string pattern : {"", "z_", "ex__st", "ex_st", "exis_", "_xist",
+                           "_x_s_", "an_", "___", "a", "_", "__"}) {
+        for (unsigned int k : {0, 1, 2, 5}) {
+            EXPECT_EQ(frozen->predictUnderscores(pattern, k),
+                      dict.predictUnderscores(pattern, k));
+        }
+    }
+}
+
+TEST_F(SmallFrozenDictTrieFixture, FROZEN_COPY_TEST) {
+    // expect the frozen copy not to see later inserts
+    EXPECT_TRUE(dict.insert("anchor", 5000));
+    vector<string> vtr{"a", "an"};
+    EXPECT_EQ(frozen->predictCompletions("a", 2), vtr);
+    EXPECT_FALSE(frozen->find("anchor"));
+}
+
+TEST_F(SmallFrozenDictTrieFixture, SNAPSHOT_TEST) {
+    // expect a saved snapshot to open and answer like the original
+    const string fileName = "test_FrozenDictionaryTrie.snapshot";
+    ASSERT_TRUE(frozen->save(fileName));
+    EXPECT_TRUE(FrozenDictionaryTrie::isSnapshot(fileName));
+    FrozenDictionaryTrie* snapshot = FrozenDictionaryTrie::open(fileName);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->nodeCount(), frozen->nodeCount());
+    EXPECT_TRUE(snapshot->find("ancester"));
+    EXPECT_FALSE(snapshot->find("anc"));
+    EXPECT_EQ(snapshot->predictCompletions("", 4),
+              frozen->predictCompletions("", 4));
+    EXPECT_EQ(snapshot->predictUnderscores("___", 5),
+              frozen->predictUnderscores("___", 5));
+    delete snapshot;
+    remove(fileName.c_str());
+}
+
+TEST(FrozenDictTrieTests, INVALID_SNAPSHOT_TEST) {
+    // expect a text dictionary not to be taken for a snapshot
+    const string fileName = "test_FrozenDictionaryTrie.txt";
+    ofstream out(fileName);
+    out << "100 a\n200 ab\n";
+    out.close();
+    EXPECT_FALSE(FrozenDictionaryTrie::isSnapshot(fileName));
+    EXPECT_EQ(FrozenDictionaryTrie::open(fileName), nullptr);
+    remove(fileName.c_str());
+    // expect a missing file to fail to open
+    EXPECT_EQ(FrozenDictionaryTrie::open(fileName), nullptr);
+
+    // expect a snapshot with a sound header but nodes pointing outside the
+    // arrays to fail to open. The nodes follow the 28 byte header, each
+    // starting with its left, right, maxFreq, firstWord and word.
+    const string snapshotName = "test_FrozenDictionaryTrie.snapshot";
+    DictionaryTrie dict;
+    dict.insert("an", 10);
+    dict.insert("and", 20);
+    dict.insert("bee", 30);
+    FrozenDictionaryTrie frozen(dict);
+    auto corrupt = [&](streamoff pos, uint32_t value) {
+        ASSERT_TRUE(frozen.save(snapshotName));
+        fstream file(snapshotName, ios::in | ios::out | ios::binary);
+        file.seekp(pos);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    corrupt(28, 0);
+    FrozenDictionaryTrie* snapshot = FrozenDictionaryTrie::open(snapshotName);
+    EXPECT_NE(snapshot, nullptr);
+    delete snapshot;
+    corrupt(28, 0x7fffffff);
+    EXPECT_EQ(FrozenDictionaryTrie::open(snapshotName), nullptr);
+    corrupt(32, 0x7fffffff);
+    EXPECT_EQ(FrozenDictionaryTrie::open(snapshotName), nullptr);
+    // a child before its parent could lead a descent round in circles
+    corrupt(28 + 24, 1);
+    EXPECT_EQ(FrozenDictionaryTrie::open(snapshotName), nullptr);
+    corrupt(44, 3);
+    EXPECT_EQ(FrozenDictionaryTrie::open(snapshotName), nullptr);
+    remove(snapshotName.c_str());
+}
+
+/* expect ties in frequency broken in the byte order of the words, as in
+ *      DictionaryTrie, also for letters from 0x80 up
+ */
+TEST(FrozenDictTrieTests, NON_ASCII_TIE_TEST) {
+    DictionaryTrie dict;
+    vector<string> inputs{"caf\xc3\xa9", "cafe", "caf\xc3\xa8s", "cafZ",
+                          "ca\xe9", "cab"};
+    for (const string& word : inputs) {
+        dict.insert(word, 7);
+    }
+    FrozenDictionaryTrie frozen(dict);
+    vector<string> expected{"cab", "cafZ", "cafe", "caf\xc3\xa8s",
+                            "caf\xc3\xa9", "ca\xe9"};
+    EXPECT_EQ(dict.predictCompletions("ca", 10), expected);
+    for (unsigned int k : {1, 3, 10}) {
+        EXPECT_EQ(frozen.predictCompletions("ca", k),
+                  dict.predictCompletions("ca", k));
+        EXPECT_EQ(frozen.predictCompletions("caf", k),
+                  dict.predictCompletions("caf", k));
+        EXPECT_EQ(frozen.predictUnderscores("ca__", k),
+                  dict.predictUnderscores("ca__", k));
+    }
+    for (const string& word : inputs) {
+        EXPECT_TRUE(frozen.find(word));
+    }
+}
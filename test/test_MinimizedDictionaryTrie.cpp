@@ -0,0 +1,163 @@
+/**
+ * This File tests all the methods implemented in
+ * MinimizedDictionaryTrie, against the answers of a DictionaryTrie.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "MinimizedDictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/**
+ * Minimizes a few words sharing both their beginnings and their endings
+ */
+class SmallMinimizedTrieFixture : public ::testing::Test {
+  protected:
+    DictionaryTrie dict;
+
+  public:
+    SmallMinimizedTrieFixture() {
+        vector<string> inputs{"walking", "talking", "walked", "talked",
+                              "walk"};
+        vector<unsigned int> freqs{5, 9, 7, 9, 2};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            dict.insert(inputs[i], freqs[i]);
+        }
+    }
+};
+
+/* Empty test */
+TEST(MinimizedTrieTests, EMPTY_TEST) {
+    DictionaryTrie dict;
+    MinimizedDictionaryTrie trie(dict);
+    EXPECT_FALSE(trie.find("abrakadabra"));
+    EXPECT_FALSE(trie.find(""));
+    EXPECT_TRUE(trie.predictCompletions("", 10).empty());
+    EXPECT_TRUE(trie.predictUnderscores("a_", 10).empty());
+    EXPECT_EQ(trie.nodeCount(), 0);
+}
+
+TEST_F(SmallMinimizedTrieFixture, SMALL_FIND_TEST) {
+    MinimizedDictionaryTrie trie(dict);
+    EXPECT_TRUE(trie.find("walking"));
+    EXPECT_TRUE(trie.find("talked"));
+    EXPECT_TRUE(trie.find("walk"));
+    EXPECT_FALSE(trie.find("talk"));
+    EXPECT_FALSE(trie.find("walkin"));
+    EXPECT_FALSE(trie.find("talkings"));
+    // expect the endings "ed" and "ing" stored once for both beginnings:
+    // the start, four states each after "t" to "talk" and "w" to "walk"
+    // (which differ as "walk" is a word), e, i, n, and the end of every
+    // word
+    EXPECT_EQ(trie.nodeCount(), 13);
+    EXPECT_LT(trie.nodeCount(), dict.nodeCount());
+}
+
+TEST_F(SmallMinimizedTrieFixture, SMALL_PREDICT_TEST) {
+    MinimizedDictionaryTrie trie(dict);
+    vector<string> expected{"talked", "talking", "walked"};
+    EXPECT_EQ(trie.predictCompletions("", 3), expected);
+    expected = {"walked", "walking", "walk"};
+    EXPECT_EQ(trie.predictCompletions("wal", 10), expected);
+    expected = {"talking"};
+    EXPECT_EQ(trie.predictCompletions("talki", 10), expected);
+    EXPECT_TRUE(trie.predictCompletions("walx", 10).empty());
+    EXPECT_TRUE(trie.predictCompletions("walkings", 10).empty());
+    expected = {"talked", "walked"};
+    EXPECT_EQ(trie.predictUnderscores("_alk_d", 10), expected);
+    expected = {"walk"};
+    EXPECT_EQ(trie.predictUnderscores("w___", 10), expected);
+    EXPECT_TRUE(trie.predictUnderscores("t___", 10).empty());
+}
+
+/* expect the answers of the ternary search tree on random words built from
+ *      shared beginnings and endings, some of them erased before the
+ *      automaton is built, in far fewer states than the TST has nodes
+ */
+TEST(MinimizedTrieTests, SUFFIX_TEST) {
+    DictionaryTrie dict;
+    unsigned int seed = 14142;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    vector<string> stems{"walk", "talk", "stat", "na", "mo", "re", "a"};
+    vector<string> endings{"", "s", "ing", "ed", "tion", "tions", "er"};
+    auto randomWord = [&]() {
+        string word;
+        for (unsigned int i = 0, n = 1 + random(3); i < n; i++) {
+            word += stems[random(stems.size())];
+        }
+        return word + endings[random(endings.size())];
+    };
+
+    vector<string> words;
+    for (int i = 0; i < 3000; i++) {
+        string word = randomWord();
+        if (dict.insert(word, random(100))) {
+            words.push_back(word);
+        }
+    }
+    for (size_t i = 0; i < words.size(); i += 7) {
+        dict.erase(words[i]);
+    }
+    MinimizedDictionaryTrie trie(dict);
+    EXPECT_LT(trie.nodeCount() * 4, dict.nodeCount());
+
+    for (int i = 0; i < 500; i++) {
+        string word = randomWord();
+        EXPECT_EQ(trie.find(word), dict.find(word));
+    }
+    for (const string& word : words) {
+        EXPECT_EQ(trie.find(word), dict.find(word));
+        for (unsigned int k : {1, 5, 50}) {
+            string prefix = word.substr(0, random(word.length() + 1));
+            EXPECT_EQ(trie.predictCompletions(prefix, k),
+                      dict.predictCompletions(prefix, k));
+        }
+    }
+    vector<string> patterns{"_",         "wa__",  "_a_k_ng", "____s",
+                            "st_t__ion", "______"};
+    for (const string& pattern : patterns) {
+        for (unsigned int k : {1, 10, 1000}) {
+            EXPECT_EQ(trie.predictUnderscores(pattern, k),
+                      dict.predictUnderscores(pattern, k));
+        }
+    }
+}
+
+/* expect ties in frequency broken in the byte order of the words, as in
+ *      DictionaryTrie, also for letters from 0x80 up
+ */
+TEST(MinimizedTrieTests, NON_ASCII_TIE_TEST) {
+    DictionaryTrie dict;
+    vector<string> inputs{"caf\xc3\xa9", "cafe", "caf\xc3\xa8s", "cafZ",
+                          "ca\xe9", "cab"};
+    for (const string& word : inputs) {
+        dict.insert(word, 7);
+    }
+    MinimizedDictionaryTrie trie(dict);
+    vector<string> expected{"cab", "cafZ", "cafe", "caf\xc3\xa8s",
+                            "caf\xc3\xa9", "ca\xe9"};
+    EXPECT_EQ(dict.predictCompletions("ca", 10), expected);
+    for (unsigned int k : {1, 3, 10}) {
+        EXPECT_EQ(trie.predictCompletions("ca", k),
+                  dict.predictCompletions("ca", k));
+        EXPECT_EQ(trie.predictCompletions("caf", k),
+                  dict.predictCompletions("caf", k));
+        EXPECT_EQ(trie.predictUnderscores("ca__", k),
+                  dict.predictUnderscores("ca__", k));
+    }
+    for (const string& word : inputs) {
+        EXPECT_TRUE(trie.find(word));
+    }
+    EXPECT_FALSE(trie.find("caf\xc3"));
+}
@@ -0,0 +1,104 @@
+/**
+ * This File tests all the methods implemented in
+ * PatternAutomaton.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "PatternAutomaton.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* return: true if the automaton accepts the whole word */
+static bool matches(const PatternAutomaton& automaton, const string& word) {
+    uint64_t states = automaton.start();
+    for (char letter : word) {
+        states = automaton.step(states, letter);
+    }
+    return automaton.accepts(states);
+}
+
+/* Empty test */
+TEST(PatternAutomatonTests, EMPTY_TEST) {
+    PatternAutomaton automaton;
+    // expect only the empty word to match before anything is compiled
+    EXPECT_TRUE(matches(automaton, ""));
+    EXPECT_FALSE(matches(automaton, "a"));
+    EXPECT_TRUE(automaton.compile(""));
+    EXPECT_TRUE(matches(automaton, ""));
+    char lowest;
+    char highest;
+    EXPECT_FALSE(automaton.letterRange(automaton.start(), lowest, highest));
+}
+
+TEST(PatternAutomatonTests, MALFORMED_TEST) {
+    PatternAutomaton automaton;
+    // expect a malformed pattern to match nothing
+    vector<string> patterns{"ab[cd", "?a", "ab\\", string(64, 'a')};
+    for (const string& pattern : patterns) {
+        EXPECT_FALSE(automaton.compile(pattern));
+        EXPECT_FALSE(matches(automaton, ""));
+        EXPECT_FALSE(matches(automaton, "ab"));
+        EXPECT_EQ(automaton.start(), 0);
+    }
+    EXPECT_TRUE(automaton.compile(string(63, 'a')));
+    EXPECT_TRUE(matches(automaton, string(63, 'a')));
+    EXPECT_FALSE(matches(automaton, string(62, 'a')));
+}
+
+TEST(PatternAutomatonTests, MATCH_TEST) {
+    PatternAutomaton automaton;
+    EXPECT_TRUE(automaton.compile("c_t"));
+    EXPECT_TRUE(matches(automaton, "cat"));
+    EXPECT_FALSE(matches(automaton, "ct"));
+    EXPECT_FALSE(matches(automaton, "cart"));
+
+    EXPECT_TRUE(automaton.compile("c*t"));
+    EXPECT_TRUE(matches(automaton, "ct"));
+    EXPECT_TRUE(matches(automaton, "cart"));
+    EXPECT_FALSE(matches(automaton, "carts"));
+
+    EXPECT_TRUE(automaton.compile("[b-d]a[^rt]s?"));
+    EXPECT_TRUE(matches(automaton, "bag"));
+    EXPECT_TRUE(matches(automaton, "dabs"));
+    EXPECT_FALSE(matches(automaton, "car"));
+    EXPECT_FALSE(matches(automaton, "fan"));
+
+    EXPECT_TRUE(automaton.compile("a\\*\\_[\\]x]"));
+    EXPECT_TRUE(matches(automaton, "a*_]"));
+    EXPECT_TRUE(matches(automaton, "a*_x"));
+    EXPECT_FALSE(matches(automaton, "ab_x"));
+
+    // expect the states to die once no match can follow
+    EXPECT_TRUE(automaton.compile("ab*"));
+    uint64_t states = automaton.step(automaton.start(), 'b');
+    EXPECT_EQ(states, 0);
+    states = automaton.step(automaton.step(automaton.start(), 'a'), 'b');
+    EXPECT_TRUE(automaton.accepts(states));
+    EXPECT_TRUE(automaton.alive(states));
+}
+
+TEST(PatternAutomatonTests, LETTER_RANGE_TEST) {
+    PatternAutomaton automaton;
+    char lowest;
+    char highest;
+    EXPECT_TRUE(automaton.compile("[k-m]?[cx]"));
+    // expect the range of every letter that can come first
+    EXPECT_TRUE(automaton.letterRange(automaton.start(), lowest, highest));
+    EXPECT_EQ(lowest, 'c');
+    EXPECT_EQ(highest, 'x');
+    uint64_t states = automaton.step(automaton.start(), 'l');
+    EXPECT_TRUE(automaton.letterRange(states, lowest, highest));
+    EXPECT_EQ(lowest, 'c');
+    EXPECT_EQ(highest, 'x');
+    // expect no letter after the end of the pattern
+    states = automaton.step(states, 'c');
+    EXPECT_TRUE(automaton.accepts(states));
+    EXPECT_FALSE(automaton.letterRange(states, lowest, highest));
+}
@@ -0,0 +1,103 @@
+/**
+ * This File tests all the methods implemented in
+ * PatternIndex.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "PatternIndex.hpp"
+#include "WordPool.hpp"
+
+using namespace std;
+using namespace testing;
+
+/**
+ * Indexes a small pool of words with tied frequencies
+ */
+class SmallPatternIndexFixture : public ::testing::Test {
+  protected:
+    WordPool pool;
+    PatternIndex index;
+
+  public:
+    SmallPatternIndexFixture() {
+        vector<string> inputs{"cat", "car", "cab", "bat",  "bar",
+                              "a",   "at",  "cart", "care", "cast"};
+        vector<unsigned int> freqs{5, 9, 5, 7, 9, 3, 1, 2, 2, 8};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            pool.add(inputs[i], freqs[i]);
+        }
+        index.build(pool);
+    }
+
+    /* return: the texts of the words matching the pattern, best first */
+    vector<string> match(const string& pattern, unsigned int k) {
+        vector<uint32_t> ids;
+        index.match(pattern, k, ids);
+        vector<string> texts;
+        for (uint32_t id : ids) {
+            texts.push_back(string(pool.text(id)));
+        }
+        return texts;
+    }
+};
+
+/* Empty test */
+TEST(PatternIndexTests, EMPTY_TEST) {
+    WordPool pool;
+    PatternIndex index;
+    vector<uint32_t> ids{1, 2};
+    index.match("a_", 10, ids);
+    EXPECT_EQ(ids.size(), 0);
+    index.build(pool);
+    index.match("", 10, ids);
+    EXPECT_EQ(ids.size(), 0);
+    EXPECT_EQ(index.memoryUsage(), 0);
+}
+
+TEST_F(SmallPatternIndexFixture, SMALL_MATCH_TEST) {
+    // expect a pattern without letters to give the best words of its
+    //      length, ties broken alphabetically
+    vector<string> vtr1{"bar", "car", "bat", "cab", "cat"};
+    EXPECT_EQ(match("___", 10), vtr1);
+    vector<string> vtr2{"bar", "car"};
+    EXPECT_EQ(match("___", 2), vtr2);
+    // expect the lists of the fixed letters to be intersected
+    vector<string> vtr3{"car", "cab", "cat"};
+    EXPECT_EQ(match("c__", 10), vtr3);
+    vector<string> vtr4{"bar", "car"};
+    EXPECT_EQ(match("_ar", 10), vtr4);
+    vector<string> vtr5{"cast", "care", "cart"};
+    EXPECT_EQ(match("ca__", 10), vtr5);
+    vector<string> vtr6{"care"};
+    EXPECT_EQ(match("c_re", 10), vtr6);
+    EXPECT_EQ(match("c_re", 0).size(), 0);
+    // expect a pattern without underscores to match itself only
+    vector<string> vtr7{"at"};
+    EXPECT_EQ(match("at", 10), vtr7);
+    // expect no match for a missing letter or length
+    EXPECT_EQ(match("_x_", 10).size(), 0);
+    EXPECT_EQ(match("b_b", 10).size(), 0);
+    EXPECT_EQ(match("_____", 10).size(), 0);
+    EXPECT_EQ(match("", 10).size(), 0);
+}
+
+TEST_F(SmallPatternIndexFixture, SMALL_SNAPSHOT_TEST) {
+    // expect words added after the build to be left out until the next
+    //      build
+    pool.add("cap", 100);
+    vector<string> vtr1{"car"};
+    EXPECT_EQ(match("ca_", 1), vtr1);
+    index.build(pool);
+    vector<string> vtr2{"cap"};
+    EXPECT_EQ(match("ca_", 1), vtr2);
+    EXPECT_GT(index.memoryUsage(), 0);
+    index.clear();
+    EXPECT_EQ(match("ca_", 1).size(), 0);
+    EXPECT_EQ(index.memoryUsage(), 0);
+}
@@ -0,0 +1,180 @@
+/**
+ * This File tests all the methods implemented in
+ * RadixDictionaryTrie, against the answers of a DictionaryTrie.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "RadixDictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/**
+ * Inserts a few phrases, so that fragments get split on the way
+ */
+class SmallRadixTrieFixture : public ::testing::Test {
+  protected:
+    RadixDictionaryTrie trie;
+
+  public:
+    SmallRadixTrieFixture() {
+        vector<string> inputs{"abstract art", "abstract", "absent",
+                              "a",            "abs",      "absent minded",
+                              "ab"};
+        vector<unsigned int> freqs{5, 9, 7, 3, 9, 1, 2};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            trie.insert(inputs[i], freqs[i]);
+        }
+    }
+};
+
+/* Empty test */
+TEST(RadixTrieTests, EMPTY_TEST) {
+    RadixDictionaryTrie trie;
+    EXPECT_FALSE(trie.find("abrakadabra"));
+    EXPECT_FALSE(trie.find(""));
+    EXPECT_FALSE(trie.insert("", 3));
+    EXPECT_TRUE(trie.predictCompletions("", 10).empty());
+    EXPECT_TRUE(trie.predictUnderscores("a_", 10).empty());
+    EXPECT_EQ(trie.nodeCount(), 0);
+}
+
+TEST_F(SmallRadixTrieFixture, SMALL_FIND_TEST) {
+    EXPECT_TRUE(trie.find("abstract art"));
+    EXPECT_TRUE(trie.find("abs"));
+    EXPECT_TRUE(trie.find("ab"));
+    EXPECT_FALSE(trie.find("abstr"));
+    EXPECT_FALSE(trie.find("absent mind"));
+    EXPECT_FALSE(trie.find("abstract arts"));
+    EXPECT_FALSE(trie.insert("absent", 100));
+    // expect a node per fragment: a, b, s, tract, " art", ent, " minded"
+    EXPECT_EQ(trie.nodeCount(), 7);
+}
+
+TEST_F(SmallRadixTrieFixture, SMALL_PREDICT_TEST) {
+    vector<string> expected{"abs", "abstract", "absent"};
+    EXPECT_EQ(trie.predictCompletions("", 3), expected);
+    expected = {"abstract", "abstract art"};
+    EXPECT_EQ(trie.predictCompletions("abstr", 10), expected);
+    EXPECT_EQ(trie.predictCompletions("abstract", 10), expected);
+    expected = {"absent minded"};
+    EXPECT_EQ(trie.predictCompletions("absent m", 10), expected);
+    EXPECT_TRUE(trie.predictCompletions("abx", 10).empty());
+    EXPECT_TRUE(trie.predictCompletions("abstract arts", 10).empty());
+    expected = {"abstract"};
+    EXPECT_EQ(trie.predictUnderscores("ab______", 10), expected);
+    expected = {"absent"};
+    EXPECT_EQ(trie.predictUnderscores("a_s_n_", 10), expected);
+    EXPECT_EQ(trie.predictUnderscores("abs_ent", 10), vector<string>{});
+    expected = {"abstract art"};
+    EXPECT_EQ(trie.predictUnderscores("abs__act_a_t", 10), expected);
+}
+
+/* expect the answers of the ternary search tree on random phrases, with
+ *      fragments split at every position and inserts in no particular
+ *      order, in far fewer nodes
+ */
+TEST(RadixTrieTests, PHRASE_TEST) {
+    RadixDictionaryTrie trie;
+    DictionaryTrie dict;
+    unsigned int seed = 16180;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    vector<string> parts{"a", "ab", "the", "then", "theme", " ", "park"};
+    auto randomWord = [&]() {
+        string word;
+        for (unsigned int i = 0, n = 1 + random(5); i < n; i++) {
+            word += parts[random(parts.size())];
+        }
+        return word;
+    };
+
+    vector<string> words;
+    for (int i = 0; i < 3000; i++) {
+        string word = randomWord();
+        unsigned int freq = random(100);
+        EXPECT_EQ(trie.insert(word, freq), dict.insert(word, freq));
+        words.push_back(word);
+    }
+    EXPECT_LT(trie.nodeCount(), dict.nodeCount());
+
+    for (int i = 0; i < 500; i++) {
+        string word = randomWord();
+        EXPECT_EQ(trie.find(word), dict.find(word));
+    }
+    for (const string& word : words) {
+        EXPECT_TRUE(trie.find(word));
+        for (unsigned int k : {1, 5, 50}) {
+            string prefix = word.substr(0, random(word.length() + 1));
+            EXPECT_EQ(trie.predictCompletions(prefix, k),
+                      dict.predictCompletions(prefix, k));
+        }
+    }
+    vector<string> patterns{"_",       "a_",    "th_n",  "__e__",
+                            "_h_m_ _", "______", "p_rk a"};
+    for (const string& pattern : patterns) {
+        for (unsigned int k : {1, 10, 1000}) {
+            EXPECT_EQ(trie.predictUnderscores(pattern, k),
+                      dict.predictUnderscores(pattern, k));
+        }
+    }
+}
+
+/* expect a bulk build to give the answers of inserting the same words,
+ *      whatever their order and with repeated and empty words, in no more
+ *      nodes
+ */
+TEST(RadixTrieTests, BUILD_TEST) {
+    RadixDictionaryTrie inserted;
+    RadixDictionaryTrie built;
+    unsigned int seed = 27182;
+    auto random = [&seed](unsigned int n) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % n;
+    };
+    vector<string> parts{"a", "ab", "the", "then", "theme", " ", "park", ""};
+    vector<string> words;
+    for (int i = 0; i < 2000; i++) {
+        string word;
+        for (unsigned int j = 0, n = 1 + random(5); j < n; j++) {
+            word += parts[random(parts.size())];
+        }
+        words.push_back(word);
+    }
+    vector<pair<string_view, unsigned int>> entries;
+    for (const string& word : words) {
+        unsigned int freq = random(100);
+        inserted.insert(word, freq);
+        entries.push_back({word, freq});
+    }
+    built.buildFromSorted(entries);
+    EXPECT_LE(built.nodeCount(), inserted.nodeCount());
+
+    for (const string& word : words) {
+        EXPECT_EQ(built.find(word), !word.empty());
+        string prefix = word.substr(0, random(word.length() + 1));
+        EXPECT_EQ(built.predictCompletions(prefix, 5),
+                  inserted.predictCompletions(prefix, 5));
+    }
+    EXPECT_FALSE(built.find("thempark"));
+    vector<string> patterns{"_", "th_n", "__e__", "_h_m_ _"};
+    for (const string& pattern : patterns) {
+        EXPECT_EQ(built.predictUnderscores(pattern, 20),
+                  inserted.predictUnderscores(pattern, 20));
+    }
+
+    // a second build inserts into the populated trie
+    built.buildFromSorted({{"thempark", 3}});
+    EXPECT_TRUE(built.find("thempark"));
+}
@@ -0,0 +1,90 @@
+/**
+ * This File tests all the methods implemented in
+ * WordPool.
+ *
+ * Author: Yuening YANG
+ * Email: y3yang@ucsd.edu
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "WordPool.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* Empty test */
+TEST(WordPoolTests, EMPTY_TEST) {
+    WordPool pool;
+    EXPECT_EQ(pool.size(), 0);
+    EXPECT_EQ(pool.memoryUsage(), 0);
+    // expect an empty word to get an id too
+    EXPECT_EQ(pool.add("", 5), 1);
+    EXPECT_EQ(pool.text(1), "");
+    EXPECT_EQ(pool.freq(1), 5);
+}
+
+TEST(WordPoolTests, ADD_TEST) {
+    WordPool pool;
+    vector<string> inputs{"exist", "a", "ant", "new york"};
+    for (size_t i = 0; i < inputs.size(); i++) {
+        EXPECT_EQ(pool.add(inputs[i], i * 100), i + 1);
+    }
+    EXPECT_EQ(pool.size(), 4);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        EXPECT_EQ(pool.text(i + 1), inputs[i]);
+        EXPECT_EQ(pool.freq(i + 1), i * 100);
+    }
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0);
+    EXPECT_EQ(pool.add("again", 1), 1);
+    EXPECT_EQ(pool.text(1), "again");
+}
+
+TEST(WordPoolTests, ERASE_TEST) {
+    WordPool pool;
+    vector<string> inputs{"exist", "a", "ant"};
+    for (size_t i = 0; i < inputs.size(); i++) {
+        pool.add(inputs[i], i);
+    }
+    // expect an erased word to keep its record and its id
+    EXPECT_FALSE(pool.erased(2));
+    pool.erase(2);
+    pool.erase(2);
+    EXPECT_TRUE(pool.erased(2));
+    EXPECT_FALSE(pool.erased(3));
+    EXPECT_EQ(pool.erasedCount(), 1);
+    EXPECT_EQ(pool.text(2), "a");
+    EXPECT_EQ(pool.size(), 3);
+    // expect the ids added later not to be erased
+    EXPECT_EQ(pool.add("a", 5), 4);
+    EXPECT_FALSE(pool.erased(4));
+    pool.clear();
+    EXPECT_EQ(pool.erasedCount(), 0);
+    EXPECT_EQ(pool.add("again", 1), 1);
+    EXPECT_FALSE(pool.erased(1));
+}
+
+TEST(WordPoolTests, GROW_TEST) {
+    // expect the texts to stay in place while the pool grows, also past
+    //      a text longer than a whole chunk
+    WordPool pool;
+    vector<string> inputs;
+    vector<const char*> starts;
+    for (int i = 0; i < 50000; i++) {
+        inputs.push_back("word" + to_string(i));
+        if (i == 20000) {
+            inputs.back() = string(WordPool::FIRST_CHUNK * 3, 'x');
+        }
+        pool.add(inputs.back(), i);
+        starts.push_back(pool.text(i + 1).data());
+    }
+    for (size_t i = 0; i < inputs.size(); i++) {
+        EXPECT_EQ(pool.text(i + 1), inputs[i]);
+        EXPECT_EQ(pool.text(i + 1).data(), starts[i]);
+        EXPECT_EQ(pool.freq(i + 1), i);
+    }
+    EXPECT_GE(pool.memoryUsage(), WordPool::FIRST_CHUNK * 3);
+}